@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#include "node_pool.hh"
+#include "order.hh"
+#include "price_ladder.hh"
+
+/*
+    One side of a book: its resting limit orders and its stop orders, with
+    the price ordering of the side fixed at compile time, so that code
+    templated on the side has no runtime side tests.
+
+    Bids are best first by std::greater, asks by std::less. Stops are kept
+    nearest first, which is the other side's order: the lowest buy stop
+    and the highest sell stop are the first to fire.
+*/
+template<OrderSide Side>
+class BookSide{
+    public:
+        static constexpr OrderSide opposite = Side == OrderSide::BUY ? OrderSide::SELL : OrderSide::BUY;
+        using Comp = std::conditional_t<Side == OrderSide::BUY, std::greater<unsigned>, std::less<unsigned>>;
+        using StopComp = std::conditional_t<Side == OrderSide::BUY, std::less<unsigned>, std::greater<unsigned>>;
+        // worse than any price: what best() and market_price() are with
+        // nothing on the side
+        static constexpr unsigned NO_PRICE = Side == OrderSide::BUY ? 0 : std::numeric_limits<unsigned>::max();
+        static constexpr unsigned NO_STOP = Side == OrderSide::BUY ? std::numeric_limits<unsigned>::max() : 0;
+
+        // price level -> the level's queue of resting orders, best first
+        PriceLadder<Comp> levels;
+        // stop price -> the level's queue of stop orders, nearest first
+        PriceLadder<StopComp> stops;
+        // last price at which an order of this side traded while resting
+        unsigned last_price = NO_PRICE;
+        // nearest stop price, NO_STOP if none; see update_trigger()
+        unsigned stop_trigger = NO_STOP;
+
+        BookSide(SlabPool* nodes, PoolArena* arena, unsigned tick) :
+            levels(nodes, arena, tick),
+            stops(nodes, arena, tick)
+            {}
+
+        // whether 'a' is a better price than 'b' on this side
+        static bool better(unsigned a, unsigned b){ return Comp()(a, b); }
+
+        unsigned best() const{ return levels.empty() ? NO_PRICE : levels.best(); }
+        // the better of the best level and the last trade
+        unsigned market_price() const{ return better(last_price, best()) ? last_price : best(); }
+
+        // whether an order of the other side quoting 'quote' trades with
+        // the level at 'price'
+        static bool reaches(unsigned quote, unsigned price){ return !better(quote, price); }
+
+        // whether a stop of this side at 'stop' fires with the other side's
+        // market at 'market': a buy stop once the sell market reaches it, a
+        // sell stop once the buy market comes down to it
+        static bool crossed(unsigned stop, unsigned market){ return !StopComp()(market, stop); }
+
+        void update_trigger(){ stop_trigger = stops.empty() ? NO_STOP : stops.best(); }
+        // whether the nearest stop may fire; one comparison, also true when
+        // there is no stop and 'market' is NO_STOP as well
+        bool stop_crossed(unsigned market) const{ return crossed(stop_trigger, market); }
+};
@@ -1,5 +1,7 @@
 #include "central_order_book.hh"
 
+#include <tuple>
+
 /*
     Add a stock symbol 'symbol' to the Central Order Book.
 */
@@ -8,30 +10,132 @@ StatusCode CentralOrderBook::add_symbol(std::string symbol){
     if (order_book_map.count(symbol) != 0){
         status = StatusCode :: SYMBOL_EXISTS;
     } else{
-        order_book_map[symbol] = OrderBook(symbol);
+        OrderBook& book = order_book_map.emplace(std::piecewise_construct,
+                                                 std::forward_as_tuple(symbol),
+                                                 std::forward_as_tuple(symbol, mode)).first->second;
+        symbol_book_map[make_symbol_key(symbol)] = &book;
+        if (book_orders != 0 || book_levels != 0){
+            book.reserve(book_orders, book_levels);
+        }
         status = StatusCode :: OK;
     }
     return status;
 }
 
+/*
+    Pre-allocate the books and the ticket map.
+*/
+void CentralOrderBook::reserve(size_t orders, size_t levels, size_t tickets){
+    book_orders = orders;
+    book_levels = levels;
+    for (auto& book : order_book_map){
+        book.second.reserve(orders, levels);
+    }
+    order_ticket_map.reserve(tickets);
+}
+
+/*
+    Sum of the pool statistics of all books; the ticket map counts as
+    order lookup slots.
+*/
+BookPoolStats CentralOrderBook::get_pool_stats() const{
+    BookPoolStats stats;
+    stats.index = order_ticket_map.get_stats();
+    for (const auto& book : order_book_map){
+        stats += book.second.get_pool_stats();
+    }
+    return stats;
+}
+
+/*
+    Fetch the order book of 'symbol', creating it if needed.
+*/
+OrderBook* CentralOrderBook::find_or_add_book(const std::string& symbol){
+    auto order_book_ptr = order_book_map.find(symbol);
+    if (order_book_ptr == order_book_map.end()){
+        add_symbol(symbol);
+        order_book_ptr = order_book_map.find(symbol);
+    }
+    return &(order_book_ptr->second);
+}
+
+/*
+    Fetch the order book of a packed symbol, creating it if needed.
+*/
+OrderBook* CentralOrderBook::find_or_add_book(SymbolKey symbol){
+    auto book_ptr = symbol_book_map.find(symbol);
+    if (book_ptr == symbol_book_map.end()){
+        return find_or_add_book(symbol_name(symbol));
+    }
+    return book_ptr->second;
+}
+
+/*
+    Bring the tickets up to date after an add of order 'order_id' to
+    'book': the order gets one if it rests, and in MATCHING mode the orders
+    it traded away or whose stops it fired lose theirs.
+*/
+void CentralOrderBook::update_tickets(OrderBook* book, OrderId order_id){
+    if (mode == BookMode :: PASSIVE){
+        order_ticket_map.insert_or_assign(order_id, book);
+        return;
+    }
+    for (OrderId id : book->departed_orders()){
+        if (!book->has_order(id)){
+            order_ticket_map.erase(id);
+        }
+    }
+    if (book->has_order(order_id)){
+        order_ticket_map.insert_or_assign(order_id, book);
+    }
+}
+
 /*
     Adds an order of a particular symbol to the order book. 
 */
 StatusCode CentralOrderBook::add_order(std::string symbol, Order& order){
-    StatusCode status;
-    auto order_book_ptr = order_book_map.find(symbol);
+    OrderBook* book = find_or_add_book(symbol);
+    StatusCode status = book->add_order(order);
+    if (status == StatusCode::OK)
+    {
+        update_tickets(book, order.get_id());
+    }
+    return status;
+}
 
-    // if not found then create an orderbook
-    if (order_book_ptr == order_book_map.end()){
-        // std::cout << "symbol not found";
-        status = add_symbol(symbol);
-    } else{
-        // std::cout << "symbol found";
-        status = (order_book_ptr->second).add_order(order);
+/*
+    Adds an order of a packed symbol to the order book.
+*/
+StatusCode CentralOrderBook::add_order(SymbolKey symbol, Order& order){
+    OrderBook* book = find_or_add_book(symbol);
+    StatusCode status = book->add_order(order);
+    if (status == StatusCode::OK)
+    {
+        update_tickets(book, order.get_id());
     }
+    return status;
+}
+
+/*
+    Bind stock locate code 'locate' to the book of 'symbol'.
+*/
+StatusCode CentralOrderBook::add_locate(uint16_t locate, SymbolKey symbol){
+    locate_book_map[locate] = find_or_add_book(symbol);
+    return StatusCode :: OK;
+}
+
+/*
+    Adds an order to the book bound to stock locate code 'locate'.
+*/
+StatusCode CentralOrderBook::add_order_by_locate(uint16_t locate, Order& order){
+    OrderBook* book = locate_book_map[locate];
+    if (book == nullptr){
+        return StatusCode :: SYMBOL_NOT_EXISTS;
+    }
+    StatusCode status = book->add_order(order);
     if (status == StatusCode::OK)
     {
-        order_ticket_map[order.get_id()] = symbol;
+        update_tickets(book, order.get_id());
     }
     return status;
 }
@@ -39,41 +143,95 @@ StatusCode CentralOrderBook::add_order(std::string symbol, Order& order){
 /*
     Fetch an order of a particular symbol and order ID from the order book. 
 */
-std::optional<Order> CentralOrderBook::get_order(unsigned int order_id){
-    auto order_ticket_ptr = order_ticket_map.find(order_id);
-    if (order_ticket_ptr == order_ticket_map.end()){
+std::optional<Order> CentralOrderBook::get_order(OrderId order_id) const{
+    OrderBook* const* book = order_ticket_map.find(order_id);
+    if (book == nullptr){
         return {};
     }
-    std::string symbol = order_ticket_ptr->second;
-    auto order_book_ptr = order_book_map.find(symbol);
-    return (order_book_ptr->second).get_order(order_id);
+    return (*book)->get_order(order_id);
 }
 
 /*
     Delete an order of an order ID from the order book.
 */
-StatusCode CentralOrderBook::delete_order(unsigned int order_id){
+StatusCode CentralOrderBook::delete_order(OrderId order_id){
     StatusCode status;
     // first check the order ticket map
-    auto order_ticket_ptr = order_ticket_map.find(order_id);
-    if (order_ticket_ptr == order_ticket_map.end()){
+    OrderBook** book = order_ticket_map.find(order_id);
+    if (book == nullptr){
         status = StatusCode :: ORDER_NOT_EXISTS;
     }
     else {
-        std::string sym = order_ticket_ptr->second;
         // then go to the order book
-        auto order_book_ptr = order_book_map.find(sym);
-        // if (order_book_ptr == order_book_map.end()){
-        //     status = StatusCode :: SYMBOL_NOT_EXISTS;
-        // } else{
-            status = (order_book_ptr->second).delete_order(order_id);
-//            status = StatusCode :: OK;
-        // }
+        status = (*book)->delete_order(order_id);
         order_ticket_map.erase(order_id);
     }
     return status;
 }
 
+/*
+    Execute 'qty' shares of the order with id 'order_id'.
+*/
+StatusCode CentralOrderBook::execute_order(OrderId order_id, unsigned qty){
+    OrderBook** order_ticket_ptr = order_ticket_map.find(order_id);
+    if (order_ticket_ptr == nullptr){
+        return StatusCode :: ORDER_NOT_EXISTS;
+    }
+    OrderBook* book = *order_ticket_ptr;
+    StatusCode status = book->execute_order(order_id, qty);
+    if (!book->has_order(order_id)){
+        // fully executed (or already gone from the book)
+        order_ticket_map.erase(order_id);
+    }
+    return status;
+}
+
+/*
+    Take 'qty' shares off the order with id 'order_id', keeping its priority.
+*/
+StatusCode CentralOrderBook::reduce_order(OrderId order_id, unsigned qty){
+    OrderBook** order_ticket_ptr = order_ticket_map.find(order_id);
+    if (order_ticket_ptr == nullptr){
+        return StatusCode :: ORDER_NOT_EXISTS;
+    }
+    OrderBook* book = *order_ticket_ptr;
+    StatusCode status = book->reduce_order(order_id, qty);
+    if (!book->has_order(order_id)){
+        order_ticket_map.erase(order_id);
+    }
+    return status;
+}
+
+/*
+    Replace the order with id 'order_id' by order 'new_id' for 'qty' shares
+    at 'price', in the same book; see OrderBook::replace_order.
+*/
+StatusCode CentralOrderBook::replace_order(OrderId order_id, OrderId new_id, unsigned price, unsigned qty){
+    OrderBook** order_ticket_ptr = order_ticket_map.find(order_id);
+    if (order_ticket_ptr == nullptr){
+        return StatusCode :: ORDER_NOT_EXISTS;
+    }
+    if (new_id != order_id && order_ticket_map.contains(new_id)){
+        return StatusCode :: ORDER_EXISTS;
+    }
+    OrderBook* book = *order_ticket_ptr;
+    StatusCode status = book->replace_order(order_id, new_id, price, qty);
+    if (status != StatusCode :: OK){
+        return status;
+    }
+    order_ticket_map.erase(order_id);
+    // the replacement may have traded away in MATCHING mode
+    if (book->has_order(new_id)){
+        order_ticket_map.insert_or_assign(new_id, book);
+    }
+    for (OrderId id : book->departed_orders()){
+        if (!book->has_order(id)){
+            order_ticket_map.erase(id);
+        }
+    }
+    return status;
+}
+
 /*
     Return the best ask/sell price of a symbol.
 */
@@ -106,6 +264,39 @@ std::pair<StatusCode, unsigned> CentralOrderBook::best_bid(std::string symbol) c
     return std::make_pair(status, price);
 }
 
+/*
+    Return the size of the level at 'price' on 'side' of a symbol.
+*/
+std::pair<StatusCode, DepthSummary> CentralOrderBook::level_depth(std::string symbol, OrderSide side, unsigned price) const{
+    auto order_book_ptr = order_book_map.find(symbol);
+    if (order_book_ptr == order_book_map.end()){
+        return std::make_pair(StatusCode :: SYMBOL_NOT_EXISTS, DepthSummary());
+    }
+    return std::make_pair(StatusCode :: OK, order_book_ptr->second.level_depth(side, price));
+}
+
+/*
+    Return the size of 'side' of a symbol.
+*/
+std::pair<StatusCode, DepthSummary> CentralOrderBook::side_depth(std::string symbol, OrderSide side) const{
+    auto order_book_ptr = order_book_map.find(symbol);
+    if (order_book_ptr == order_book_map.end()){
+        return std::make_pair(StatusCode :: SYMBOL_NOT_EXISTS, DepthSummary());
+    }
+    return std::make_pair(StatusCode :: OK, order_book_ptr->second.side_depth(side));
+}
+
+/*
+    Fill 'out' with up to 'n' levels of 'side' of a symbol, best first.
+*/
+std::pair<StatusCode, size_t> CentralOrderBook::depth(std::string symbol, OrderSide side, DepthLevel* out, size_t n) const{
+    auto order_book_ptr = order_book_map.find(symbol);
+    if (order_book_ptr == order_book_map.end()){
+        return std::make_pair(StatusCode :: SYMBOL_NOT_EXISTS, size_t(0));
+    }
+    return std::make_pair(StatusCode :: OK, order_book_ptr->second.depth(side, out, n));
+}
+
 // Print the order book contents - internally used for debugging
 void CentralOrderBook::printBuySellPool(std::string symbol)const{
     order_book_map.at(symbol).printBuySellPool();
@@ -1,5 +1,9 @@
+#include <cstdint>
 #include <unordered_map>
+#include <vector>
+#include "order_table.hh"
 #include "orderbook.hh"
+#include "symbol.hh"
 
 /*
     The main Order Book class that maintains the order book for different
@@ -7,23 +11,97 @@
 */
 class CentralOrderBook {
     private:
+        // mode of every book created by this central book
+        BookMode mode;
         // map of stock symbol to its order book
         std::unordered_map<std::string, OrderBook> order_book_map;
-        // store a hash map of orderID to symbols
-        std::unordered_map<unsigned int, std::string> order_ticket_map;
+        // packed symbol to its order book (in order_book_map)
+        std::unordered_map<SymbolKey, OrderBook*> symbol_book_map;
+        // orderID to the book holding the order, indexed directly by id
+        OrderTable<OrderBook*> order_ticket_map;
+        // reserve() of every book, including books added later
+        size_t book_orders = 0;
+        size_t book_levels = 0;
+
+        // ITCH stock locate code to its order book, nullptr if not registered
+        std::vector<OrderBook*> locate_book_map = std::vector<OrderBook*>(UINT16_MAX + 1, nullptr);
+
+        OrderBook* find_or_add_book(const std::string&);
+        OrderBook* find_or_add_book(SymbolKey);
+        void update_tickets(OrderBook*, OrderId);
 public:
-        
+        CentralOrderBook(BookMode mode = BookMode::MATCHING) : mode(mode) {}
+
         StatusCode add_symbol(std::string);
+
+        // pre-allocate every book, now and when it is added, for 'orders'
+        // resting orders and 'levels' price levels (see OrderBook::reserve),
+        // and the ticket map for 'tickets' orders across all books
+        void reserve(size_t orders, size_t levels, size_t tickets);
+
+        // utilisation of the slab pools of all books and of the ticket map
+        BookPoolStats get_pool_stats() const;
         
         StatusCode add_order(std::string, Order&);
+
+        // same as above with a packed symbol, does not build any string
+        // once the symbol has a book
+        StatusCode add_order(SymbolKey, Order&);
         
-        StatusCode delete_order(unsigned int);
+        // bind an ITCH stock locate code (from the stock directory) to the
+        // book of a symbol, creating the book if needed
+        StatusCode add_locate(uint16_t, SymbolKey);
+
+        // book of a stock locate code, nullptr if it was never added
+        OrderBook* book_by_locate(uint16_t locate) const{
+            return locate_book_map[locate];
+        }
+
+        // same as add_order with the book found by stock locate code
+        StatusCode add_order_by_locate(uint16_t, Order&);
 
-        std::optional<Order> get_order(unsigned int);
+        StatusCode delete_order(OrderId);
+
+        // ITCH E/C: 'qty' shares of a resting order were executed
+        StatusCode execute_order(OrderId, unsigned);
+
+        // ITCH X: take 'qty' shares off a resting order, keeping its priority
+        StatusCode reduce_order(OrderId, unsigned);
+
+        // ITCH U: replace an order by 'new_id' at 'price' for 'qty' shares
+        StatusCode replace_order(OrderId, OrderId, unsigned, unsigned);
+
+        // number of orders with a ticket, i.e. resting or waiting as stops
+        size_t order_count() const{ return order_ticket_map.size(); }
+
+        // a copy of the resting order, none if there is none
+        std::optional<Order> get_order(OrderId) const;
 
         std::pair<StatusCode, unsigned> best_ask(std::string) const;
 
         std::pair<StatusCode, unsigned> best_bid(std::string) const;
 
+        // resting limit orders of a symbol at a price on a side
+        std::pair<StatusCode, DepthSummary> level_depth(std::string, OrderSide, unsigned) const;
+
+        // all resting limit orders of a symbol on a side
+        std::pair<StatusCode, DepthSummary> side_depth(std::string, OrderSide) const;
+
+        // top levels of a symbol on a side, see OrderBook::depth; the
+        // number of levels written
+        std::pair<StatusCode, size_t> depth(std::string, OrderSide, DepthLevel*, size_t) const;
+
+        // snapshots of up to 'max_books' books, in no particular order,
+        // into 'out'; returns how many
+        template<size_t N>
+        size_t snapshot_all(std::pair<SymbolKey, DepthSnapshot<N>>* out, size_t max_books) const{
+            size_t count = 0;
+            for (auto book = symbol_book_map.begin(); book != symbol_book_map.end() && count < max_books; ++book, ++count){
+                out[count].first = book->first;
+                book->second->snapshot(out[count].second);
+            }
+            return count;
+        }
+
         void printBuySellPool(std::string) const;
 };
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "node_pool.hh"
+#include "order.hh"
+#include "order_queue.hh"
+
+/*
+    The attributes of a resting order that matching never reads.
+*/
+struct ColdOrder{
+    std::chrono::time_point<std::chrono::system_clock> timestamp;
+    unsigned owner;
+    unsigned quote;
+    unsigned stop_price;
+    unsigned original_quantity;
+    OrderSide side;
+    OrderType type;
+};
+
+/*
+    ColdOrders of a book's resting orders, by handle. Handles of departed
+    orders are reused, so the table stays as big as the book's peak.
+*/
+class ColdOrderTable{
+    private:
+        std::vector<ColdOrder> orders;
+        std::vector<unsigned> free_handles;
+
+    public:
+        // store the cold attributes of 'order', returns their handle
+        unsigned insert(const Order& order){
+            ColdOrder cold = {order.get_time(), order.get_owner(), order.get_quote(), order.get_stop_price(),
+                              order.get_quantity(), order.get_side(), order.get_type()};
+            if(free_handles.empty()){
+                orders.push_back(cold);
+                return static_cast<unsigned>(orders.size() - 1);
+            }
+            unsigned handle = free_handles.back();
+            free_handles.pop_back();
+            orders[handle] = cold;
+            return handle;
+        }
+        // the order is gone; its attributes stay readable until the next insert
+        void release(unsigned handle){ free_handles.push_back(handle); }
+
+        const ColdOrder& operator[](unsigned handle) const{ return orders[handle]; }
+
+        // the full resting order of 'node'
+        Order make_order(const OrderNode& node) const{
+            const ColdOrder& cold = orders[node.cold];
+            return Order(node.id, cold.owner, cold.quote, cold.stop_price, node.quantity, cold.side, cold.type,
+                         node.aon, cold.timestamp);
+        }
+
+        void reserve(size_t count){
+            orders.reserve(count);
+            free_handles.reserve(count);
+        }
+        // one block per order; peak is the most orders ever held at once
+        PoolStats get_stats() const{
+            PoolStats stats;
+            stats.in_use = orders.size() - free_handles.size();
+            stats.capacity = orders.capacity();
+            stats.peak = orders.size();
+            stats.slabs = orders.capacity() != 0 ? 1 : 0;
+            stats.bytes = orders.capacity() * sizeof(ColdOrder) + free_handles.capacity() * sizeof(unsigned);
+            return stats;
+        }
+};
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "node_pool.hh"
+
+/*
+    Open-addressing hash map from an integer id to a small trivially
+    copyable value, for order id lookups.
+
+    Robin Hood probing: every slot records how far it sits from its home
+    slot, an insert takes the slot of any entry closer to home than itself,
+    and an erase shifts the rest of the run back by one, so there are no
+    tombstones and probe runs stay short at 7/8 load.
+
+    Growing never rehashes everything at once. A bigger table takes new
+    entries while every insert or erase also moves a few whole runs out of
+    the old one; lookups check both until the old table is empty. reserve()
+    sizes the table up front instead.
+
+    Pointers to values stay valid until the next insert or erase.
+*/
+template<typename Key, typename Value>
+class FlatHashMap{
+    private:
+        static_assert(std::is_integral<Key>::value, "integer ids");
+        static_assert(std::is_trivially_copyable<Value>::value, "values are moved as bytes");
+
+        // old slots moved per insert or erase while growing; the new table
+        // is twice the old one, so this finishes long before it fills up
+        static constexpr size_t MIGRATE_STEP = 16;
+        static constexpr size_t MIN_CAPACITY = 16;
+
+        struct Slot{
+            Key key;
+            uint32_t distance; // from the home slot, plus one; 0 if empty
+            Value value;
+        };
+
+        struct Table{
+            std::unique_ptr<Slot[]> slots;
+            size_t mask = 0;
+            unsigned shift = 64;
+            size_t count = 0;
+
+            Table() = default;
+            Table(Table&& other) noexcept{ *this = std::move(other); }
+            Table& operator=(Table&& other) noexcept{
+                slots = std::move(other.slots);
+                mask = other.mask;
+                shift = other.shift;
+                count = other.count;
+                other.mask = 0;
+                other.shift = 64;
+                other.count = 0;
+                return *this;
+            }
+
+            size_t capacity() const{ return slots ? mask + 1 : 0; }
+            // grow once beyond 7/8 load
+            size_t max_load() const{ return capacity() - capacity() / 8; }
+            // Fibonacci hashing spreads sequential ids over the table
+            size_t home(Key key) const{
+                return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> shift);
+            }
+
+            void allocate(size_t capacity){
+                slots.reset(new Slot[capacity]());
+                mask = capacity - 1;
+                shift = 64 - __builtin_ctzll(capacity);
+                count = 0;
+            }
+            Slot* find(Key key) const{
+                if(!slots){
+                    return nullptr;
+                }
+                size_t index = home(key);
+                for(uint32_t distance = 1; slots[index].distance >= distance; ++distance){
+                    if(slots[index].key == key){
+                        return &slots[index];
+                    }
+                    index = (index + 1) & mask;
+                }
+                return nullptr;
+            }
+            // 'key' must not be in the table and must fit
+            Value* insert(Key key, const Value& value){
+                Slot incoming{key, 1, value};
+                Value* placed = nullptr;
+                size_t index = home(key);
+                while(true){
+                    Slot& slot = slots[index];
+                    if(slot.distance == 0){
+                        slot = incoming;
+                        ++count;
+                        return placed ? placed : &slot.value;
+                    }
+                    if(slot.distance < incoming.distance){
+                        std::swap(slot, incoming);
+                        placed = placed ? placed : &slot.value;
+                    }
+                    index = (index + 1) & mask;
+                    ++incoming.distance;
+                }
+            }
+            void erase(Slot* slot){
+                size_t index = static_cast<size_t>(slot - slots.get());
+                size_t next = (index + 1) & mask;
+                while(slots[next].distance > 1){
+                    slots[index] = slots[next];
+                    --slots[index].distance;
+                    index = next;
+                    next = (next + 1) & mask;
+                }
+                slots[index].distance = 0;
+                --count;
+            }
+        };
+
+        Table table;
+        // the table being emptied into 'table' while growing
+        Table old;
+        // next old slot to move; always stops on an empty one
+        size_t migrate_index = 0;
+        size_t peak = 0;
+
+        /*
+            Move about 'budget' slots of the old table. Runs move as a
+            whole, stopping only at an empty slot, so a lookup of a key left
+            behind never crosses an emptied run.
+        */
+        void migrate(size_t budget){
+            while(old.slots){
+                Slot& slot = old.slots[migrate_index];
+                if(slot.distance != 0){
+                    table.insert(slot.key, slot.value);
+                    slot.distance = 0;
+                    --old.count;
+                }else if(old.count == 0){
+                    old = Table();
+                    return;
+                }else if(budget == 0){
+                    return;
+                }
+                migrate_index = (migrate_index + 1) & old.mask;
+                budget = budget > 0 ? budget - 1 : 0;
+            }
+        }
+        void finish_migration(){
+            migrate(~size_t(0));
+        }
+        // start moving everything into a table of 'capacity' slots
+        void grow(size_t capacity){
+            finish_migration();
+            old = std::move(table);
+            table.allocate(capacity);
+            if(old.count == 0){
+                old = Table();
+                return;
+            }
+            // at most 7/8 full, so there is an empty slot to start from
+            migrate_index = 0;
+            while(old.slots[migrate_index].distance != 0){
+                ++migrate_index;
+            }
+        }
+        static size_t capacity_for(size_t entries){
+            size_t capacity = MIN_CAPACITY;
+            while(capacity - capacity / 8 < entries){
+                capacity *= 2;
+            }
+            return capacity;
+        }
+
+    public:
+        FlatHashMap() = default;
+        FlatHashMap(const FlatHashMap&) = delete;
+        FlatHashMap& operator=(const FlatHashMap&) = delete;
+        FlatHashMap(FlatHashMap&&) noexcept = default;
+        FlatHashMap& operator=(FlatHashMap&&) noexcept = default;
+
+        size_t size() const{ return table.count + old.count; }
+        bool empty() const{ return size() == 0; }
+
+        Value* find(Key key){
+            Slot* slot = table.find(key);
+            slot = slot ? slot : old.find(key);
+            return slot ? &slot->value : nullptr;
+        }
+        const Value* find(Key key) const{
+            return const_cast<FlatHashMap*>(this)->find(key);
+        }
+        bool contains(Key key) const{ return find(key) != nullptr; }
+
+        // insert 'value' unless 'key' is present; the key's value and
+        // whether it was inserted
+        std::pair<Value*, bool> try_emplace(Key key, const Value& value){
+            migrate(MIGRATE_STEP);
+            if(Value* present = find(key)){
+                return {present, false};
+            }
+            if(table.count + 1 > table.max_load()){
+                grow(capacity_for(size() + 1));
+            }
+            Value* inserted = table.insert(key, value);
+            peak = std::max(peak, size());
+            return {inserted, true};
+        }
+        void insert_or_assign(Key key, const Value& value){
+            auto entry = try_emplace(key, value);
+            if(!entry.second){
+                *entry.first = value;
+            }
+        }
+        bool erase(Key key){
+            migrate(MIGRATE_STEP);
+            if(Slot* slot = table.find(key)){
+                table.erase(slot);
+                return true;
+            }
+            if(Slot* slot = old.find(key)){
+                old.erase(slot);
+                return true;
+            }
+            return false;
+        }
+
+        // make room for 'entries' entries without growing again; rehashes
+        // at once, so call it before the replay rather than during it
+        void reserve(size_t entries){
+            size_t capacity = capacity_for(entries);
+            if(capacity > table.capacity()){
+                grow(capacity);
+                finish_migration();
+            }
+        }
+
+        // capacity and bytes count the slots of both tables while growing
+        PoolStats get_stats() const{
+            PoolStats stats;
+            stats.in_use = size();
+            stats.capacity = table.capacity() + old.capacity();
+            stats.peak = peak;
+            stats.slabs = (table.slots ? 1 : 0) + (old.slots ? 1 : 0);
+            stats.bytes = stats.capacity * sizeof(Slot);
+            return stats;
+        }
+};
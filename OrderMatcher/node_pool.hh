@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+/*
+    Utilisation of one SlabPool, or of all pools of an arena summed up.
+    Counts are in blocks, except bytes.
+*/
+struct PoolStats{
+    size_t in_use = 0;
+    size_t capacity = 0;
+    size_t peak = 0;
+    size_t slabs = 0;
+    size_t bytes = 0;
+
+    PoolStats& operator+=(const PoolStats& other){
+        in_use += other.in_use;
+        capacity += other.capacity;
+        peak += other.peak;
+        slabs += other.slabs;
+        bytes += other.bytes;
+        return *this;
+    }
+};
+
+/*
+    Fixed-size blocks carved out of slabs and recycled through a free
+    list. Released blocks go back to the free list, never to the heap, so
+    once the pool has grown to the working set, allocating is a pointer pop.
+*/
+class SlabPool{
+    private:
+        struct FreeBlock{
+            FreeBlock* next;
+        };
+        // largest slab grown on demand, in blocks
+        static constexpr size_t MAX_SLAB_BLOCKS = 65536;
+
+        size_t block_size;
+        size_t slab_blocks;
+        std::vector<std::unique_ptr<char[]>> slabs;
+        FreeBlock* free_list = nullptr;
+        PoolStats stats;
+
+        void grow(size_t blocks){
+            // operator new[] aligns for any fundamental type
+            slabs.emplace_back(new char[blocks * block_size]);
+            char* slab = slabs.back().get();
+            for(size_t i = blocks; i-- > 0;){
+                FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + i * block_size);
+                block->next = free_list;
+                free_list = block;
+            }
+            stats.capacity += blocks;
+            stats.slabs += 1;
+            stats.bytes += blocks * block_size;
+        }
+
+    public:
+        SlabPool(size_t object_size, size_t slab_blocks) :
+            block_size((std::max(object_size, sizeof(FreeBlock)) + alignof(void*) - 1) / alignof(void*) * alignof(void*)),
+            slab_blocks(std::max<size_t>(slab_blocks, 1))
+            {}
+        SlabPool(const SlabPool&) = delete;
+        SlabPool& operator=(const SlabPool&) = delete;
+
+        void* allocate(){
+            if(free_list == nullptr){
+                // slabs double with the pool, up to MAX_SLAB_BLOCKS
+                grow(std::max(slab_blocks, std::min(stats.capacity, MAX_SLAB_BLOCKS)));
+            }
+            FreeBlock* block = free_list;
+            free_list = block->next;
+            stats.peak = std::max(stats.peak, ++stats.in_use);
+            return block;
+        }
+        void release(void* p){
+            FreeBlock* block = static_cast<FreeBlock*>(p);
+            block->next = free_list;
+            free_list = block;
+            --stats.in_use;
+        }
+        // make sure 'blocks' blocks fit without growing again
+        void reserve(size_t blocks){
+            if(stats.capacity < blocks){
+                grow(blocks - stats.capacity);
+            }
+        }
+        void reset_peak(){ stats.peak = stats.in_use; }
+        void set_slab_blocks(size_t blocks){ slab_blocks = std::max<size_t>(blocks, 1); }
+
+        size_t get_block_size() const{ return block_size; }
+        const PoolStats& get_stats() const{ return stats; }
+};
+
+/*
+    One SlabPool per block size, shared by all containers of an owner
+    (e.g. an OrderBook) through PoolAllocator.
+*/
+class PoolArena{
+    private:
+        size_t slab_blocks;
+        std::vector<std::unique_ptr<SlabPool>> pools;
+
+    public:
+        static constexpr size_t DEFAULT_SLAB_BLOCKS = 16;
+
+        explicit PoolArena(size_t slab_blocks = DEFAULT_SLAB_BLOCKS) : slab_blocks(slab_blocks){}
+        PoolArena(const PoolArena&) = delete;
+        PoolArena& operator=(const PoolArena&) = delete;
+
+        // pool of blocks fitting 'object_size' bytes, created on first use
+        SlabPool& pool(size_t object_size){
+            size_t block_size = (std::max(object_size, sizeof(void*)) + alignof(void*) - 1) / alignof(void*) * alignof(void*);
+            for(auto& pool : pools){
+                if(pool->get_block_size() == block_size){
+                    return *pool;
+                }
+            }
+            pools.push_back(std::make_unique<SlabPool>(block_size, slab_blocks));
+            return *pools.back();
+        }
+        // smallest slab of every pool, now and when created
+        void set_slab_blocks(size_t blocks){
+            slab_blocks = blocks;
+            for(auto& pool : pools){
+                pool->set_slab_blocks(blocks);
+            }
+        }
+        void reset_peak(){
+            for(auto& pool : pools){
+                pool->reset_peak();
+            }
+        }
+        PoolStats get_stats() const{
+            PoolStats total;
+            for(const auto& pool : pools){
+                total += pool->get_stats();
+            }
+            return total;
+        }
+};
+
+/*
+    Standard allocator drawing single objects (i.e. container nodes) from
+    a PoolArena. Arrays, such as hash buckets, and allocators without an
+    arena go to the heap.
+*/
+template<typename T>
+class PoolAllocator{
+    public:
+        using value_type = T;
+
+        PoolArena* arena;
+
+        explicit PoolAllocator(PoolArena* arena = nullptr) noexcept : arena(arena){}
+        template<typename U>
+        PoolAllocator(const PoolAllocator<U>& other) noexcept : arena(other.arena){}
+
+        T* allocate(size_t n){
+            static_assert(alignof(T) <= alignof(void*), "pool blocks are pointer aligned");
+            if(arena != nullptr && n == 1){
+                return static_cast<T*>(arena->pool(sizeof(T)).allocate());
+            }
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        void deallocate(T* p, size_t n) noexcept{
+            if(arena != nullptr && n == 1){
+                arena->pool(sizeof(T)).release(p);
+            }else{
+                ::operator delete(p);
+            }
+        }
+
+        template<typename U>
+        bool operator==(const PoolAllocator<U>& other) const noexcept{ return arena == other.arena; }
+        template<typename U>
+        bool operator!=(const PoolAllocator<U>& other) const noexcept{ return arena != other.arena; }
+};
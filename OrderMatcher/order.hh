@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <iostream>
 
 enum class OrderSide : unsigned char {
@@ -15,12 +16,15 @@ enum class OrderType : unsigned char {
     STOP_LIMIT // a.k.a. STOPLOSS_LIMIT
 };
 
+// ITCH order reference number: 64 bits, nearly sequential through the day
+using OrderId = uint64_t;
+
 /*
     The Order class.
 */
 class Order{
 private:
-    unsigned order_id;
+    OrderId order_id;
     unsigned owner_id;
     unsigned quantity; 
     unsigned quote;
@@ -30,7 +34,7 @@ private:
     char all_or_none; // aon=1, partial order allowed=0
     std::chrono::time_point<std::chrono::system_clock> timestamp;
 public:
-    Order(unsigned order, unsigned owner, unsigned quote, unsigned stop_price,unsigned qty, OrderSide sd, OrderType tp, char aon = 0, std::chrono::time_point<std::chrono::system_clock> tmstmp = std::chrono::system_clock::now()):
+    Order(OrderId order, unsigned owner, unsigned quote, unsigned stop_price,unsigned qty, OrderSide sd, OrderType tp, char aon = 0, std::chrono::time_point<std::chrono::system_clock> tmstmp = std::chrono::system_clock::now()):
         order_id(order),
         owner_id(owner),
         quote(quote),
@@ -40,10 +44,10 @@ public:
         order_type(tp),
         all_or_none(aon),
         timestamp(tmstmp){}
-    Order(unsigned order, unsigned owner, unsigned quote, unsigned qty, OrderSide sd, OrderType tp, char aon = 0, std::chrono::time_point<std::chrono::system_clock> tmstmp = std::chrono::system_clock::now()):
+    Order(OrderId order, unsigned owner, unsigned quote, unsigned qty, OrderSide sd, OrderType tp, char aon = 0, std::chrono::time_point<std::chrono::system_clock> tmstmp = std::chrono::system_clock::now()):
         Order(order,owner,quote,0,qty,sd,tp,aon,tmstmp)
         {}
-    unsigned get_id()const{return order_id;}
+    OrderId get_id()const{return order_id;}
     unsigned get_owner()const{return owner_id;}
     unsigned get_quantity()const{return quantity;}
     void reduce_quantity(unsigned x){quantity-=x;} // only if aon=0
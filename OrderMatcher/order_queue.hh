@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+
+#include "node_pool.hh"
+#include "order.hh"
+
+/*
+    An order resting in a price level, linked to its neighbours in time
+    priority. order_map keeps a pointer to it, so a cancel unlinks it
+    without looking at the rest of the level.
+
+    Only what matching reads and writes lives here, half a cache line per
+    order; owner, prices, side, type, time and original size stay in the
+    book's ColdOrderTable under the 'cold' handle.
+*/
+struct OrderNode{
+    OrderId id;
+    unsigned quantity; // remaining
+    unsigned cold : 31;
+    unsigned aon : 1;
+    OrderNode* prev = nullptr;
+    OrderNode* next = nullptr;
+
+    OrderNode(OrderId id, unsigned quantity, unsigned cold, bool aon) :
+        id(id),
+        quantity(quantity),
+        cold(cold),
+        aon(aon)
+        {}
+};
+static_assert(sizeof(OrderNode) <= 32, "two resting orders per cache line");
+
+/*
+    Time priority queue of a price level: an intrusive doubly-linked list
+    of OrderNodes. The queue owns its nodes; a node stays at the same
+    address until it is erased. Nodes come from 'nodes' if given, otherwise
+    from the heap.
+
+    The queue keeps its order count and total quantity as orders come, go
+    and shrink, so quantities must change through reduce().
+*/
+class OrderQueue{
+    private:
+        SlabPool* nodes = nullptr;
+        OrderNode* head = nullptr;
+        OrderNode* tail = nullptr;
+        size_t count = 0;
+        uint64_t volume = 0;
+
+        void unlink(OrderNode* node){
+            (node->prev ? node->prev->next : head) = node->next;
+            (node->next ? node->next->prev : tail) = node->prev;
+            --count;
+            volume -= node->quantity;
+        }
+        void destroy(OrderNode* node){
+            node->~OrderNode();
+            if(nodes){
+                nodes->release(node);
+            }else{
+                ::operator delete(node);
+            }
+        }
+
+    public:
+        class iterator{
+            private:
+                OrderNode* node;
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = OrderNode;
+                using difference_type = std::ptrdiff_t;
+                using pointer = OrderNode*;
+                using reference = OrderNode&;
+
+                explicit iterator(OrderNode* node = nullptr) : node(node){}
+                OrderNode& operator*() const{ return *node; }
+                OrderNode* operator->() const{ return node; }
+                iterator& operator++(){ node = node->next; return *this; }
+                iterator operator++(int){ iterator old = *this; node = node->next; return old; }
+                bool operator==(const iterator& other) const{ return node == other.node; }
+                bool operator!=(const iterator& other) const{ return node != other.node; }
+        };
+
+        explicit OrderQueue(SlabPool* nodes = nullptr) : nodes(nodes){}
+        OrderQueue(const OrderQueue&) = delete;
+        OrderQueue& operator=(const OrderQueue&) = delete;
+        OrderQueue(OrderQueue&& other) noexcept :
+            nodes(other.nodes),
+            head(other.head),
+            tail(other.tail),
+            count(other.count),
+            volume(other.volume){
+            other.head = other.tail = nullptr;
+            other.count = 0;
+            other.volume = 0;
+        }
+        OrderQueue& operator=(OrderQueue&& other) noexcept{
+            if(this != &other){
+                clear();
+                nodes = other.nodes;
+                head = other.head;
+                tail = other.tail;
+                count = other.count;
+                volume = other.volume;
+                other.head = other.tail = nullptr;
+                other.count = 0;
+                other.volume = 0;
+            }
+            return *this;
+        }
+        ~OrderQueue(){ clear(); }
+
+        // append at the back of the queue, returns the order's node
+        OrderNode* push_back(OrderId id, unsigned quantity, unsigned cold, bool aon){
+            void* block = nodes ? nodes->allocate() : ::operator new(sizeof(OrderNode));
+            OrderNode* node = new(block) OrderNode(id, quantity, cold, aon);
+            node->prev = tail;
+            (tail ? tail->next : head) = node;
+            tail = node;
+            ++count;
+            volume += quantity;
+            return node;
+        }
+        // 'node' must belong to this queue
+        void erase(OrderNode* node){
+            unlink(node);
+            destroy(node);
+        }
+        void pop_front(){ erase(head); }
+        // take 'qty' shares off 'node', which must belong to this queue
+        void reduce(OrderNode* node, unsigned qty){
+            node->quantity -= qty;
+            volume -= qty;
+        }
+        void clear(){
+            while(head){
+                OrderNode* next = head->next;
+                destroy(head);
+                head = next;
+            }
+            tail = nullptr;
+            count = 0;
+            volume = 0;
+        }
+
+        OrderNode& front(){ return *head; }
+        const OrderNode& front() const{ return *head; }
+        bool empty() const{ return count == 0; }
+        size_t size() const{ return count; }
+        // remaining quantity of all orders in the queue
+        uint64_t quantity() const{ return volume; }
+
+        iterator begin() const{ return iterator(head); }
+        iterator end() const{ return iterator(); }
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "flat_hash_map.hh"
+#include "node_pool.hh"
+#include "order.hh"
+
+/*
+    Order id -> value table for ITCH order reference numbers, which grow
+    almost monotonically through the day.
+
+    Ids in the live window [base, base + chunks * CHUNK_SIZE) are indexed
+    directly by id - base: one chunk of CHUNK_SIZE values with a live bit
+    each per CHUNK_SIZE consecutive ids, allocated when the first id in it
+    arrives and released once none of its ids is live. The window's start
+    follows the oldest live chunk, so memory follows the live orders rather
+    than the day. Ids behind the window or far ahead of it, and the live
+    ids of a chunk evicted from a window grown past MAX_CHUNKS, go to a
+    hash map fallback.
+
+    Pointers to values stay valid until the next insert or erase.
+*/
+template<typename Value>
+class OrderTable{
+    public:
+        static constexpr unsigned CHUNK_BITS = 12;
+        static constexpr OrderId CHUNK_SIZE = OrderId(1) << CHUNK_BITS;
+        // widest window, in chunks (256M ids in 512 KB of chunk pointers)
+        static constexpr size_t MAX_CHUNKS = size_t(1) << 16;
+        // ids further ahead of the window than this, in chunks, go to the
+        // fallback instead of stretching the window
+        static constexpr size_t MAX_GAP = 1024;
+
+    private:
+        static_assert(std::is_trivially_copyable<Value>::value, "values are moved as bytes");
+
+        struct Chunk{
+            uint64_t live[CHUNK_SIZE / 64];
+            size_t count;
+            Value values[CHUNK_SIZE];
+
+            bool is_live(size_t slot) const{ return (live[slot >> 6] >> (slot & 63)) & 1; }
+        };
+
+        // id of the first slot of chunks[head]
+        OrderId base = 0;
+        // the window; released chunks are nullptr, chunks before 'head'
+        // are gone and wait to be compacted away
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        size_t head = 0;
+        // released chunks kept for reuse, at most 'spare_limit'
+        std::vector<std::unique_ptr<Chunk>> spares;
+        size_t spare_limit = 1;
+        size_t direct_count = 0;
+        size_t allocated = 0;
+        size_t peak = 0;
+        FlatHashMap<OrderId, Value> fallback;
+
+        size_t window() const{ return chunks.size() - head; }
+
+        // chunk and slot of 'id' in the window, false if it is outside
+        bool locate(OrderId id, size_t& chunk, size_t& slot) const{
+            if(id < base){
+                return false;
+            }
+            OrderId offset = id - base;
+            if((offset >> CHUNK_BITS) >= window()){
+                return false;
+            }
+            chunk = head + static_cast<size_t>(offset >> CHUNK_BITS);
+            slot = static_cast<size_t>(offset & (CHUNK_SIZE - 1));
+            return true;
+        }
+
+        std::unique_ptr<Chunk> new_chunk(){
+            std::unique_ptr<Chunk> chunk;
+            if(!spares.empty()){
+                chunk = std::move(spares.back());
+                spares.pop_back();
+            }else{
+                chunk.reset(new Chunk);
+                ++allocated;
+            }
+            std::fill(std::begin(chunk->live), std::end(chunk->live), 0);
+            chunk->count = 0;
+            return chunk;
+        }
+        void release(std::unique_ptr<Chunk>& chunk){
+            if(spares.size() < spare_limit){
+                spares.push_back(std::move(chunk));
+            }else{
+                chunk.reset();
+                --allocated;
+            }
+        }
+        // forget the chunk pointers before 'head' once they are most of them
+        void compact(){
+            if(head > 64 && head > chunks.size() / 2){
+                chunks.erase(chunks.begin(), chunks.begin() + head);
+                head = 0;
+            }
+        }
+        // drop released chunks off the front of the window
+        void trim(){
+            while(head < chunks.size() && !chunks[head]){
+                ++head;
+                base += CHUNK_SIZE;
+            }
+            if(head == chunks.size()){
+                chunks.clear();
+                head = 0;
+            }
+            compact();
+        }
+        // move the live ids of the window's first chunk to the fallback
+        void evict_front(){
+            std::unique_ptr<Chunk>& chunk = chunks[head];
+            if(chunk){
+                for(size_t word = 0; word < CHUNK_SIZE / 64; ++word){
+                    for(uint64_t bits = chunk->live[word]; bits; bits &= bits - 1){
+                        size_t slot = (word << 6) + __builtin_ctzll(bits);
+                        fallback.try_emplace(base + slot, chunk->values[slot]);
+                        --direct_count;
+                    }
+                }
+                release(chunk);
+            }
+            ++head;
+            base += CHUNK_SIZE;
+            compact();
+        }
+        /*
+            Stretch the window to cover 'id', evicting the oldest chunks if
+            it gets too wide. False if 'id' belongs in the fallback.
+        */
+        bool cover(OrderId id){
+            if(window() == 0){
+                base = id & ~(CHUNK_SIZE - 1);
+                chunks.emplace_back();
+                return true;
+            }
+            if(id < base){
+                return false;
+            }
+            OrderId needed = ((id - base) >> CHUNK_BITS) + 1;
+            if(needed - window() > MAX_GAP){
+                return false;
+            }
+            chunks.resize(head + static_cast<size_t>(needed));
+            while(window() > MAX_CHUNKS){
+                evict_front();
+            }
+            return true;
+        }
+
+    public:
+        OrderTable() = default;
+        OrderTable(const OrderTable&) = delete;
+        OrderTable& operator=(const OrderTable&) = delete;
+
+        size_t size() const{ return direct_count + fallback.size(); }
+        bool empty() const{ return size() == 0; }
+
+        Value* find(OrderId id){
+            size_t chunk, slot;
+            if(locate(id, chunk, slot) && chunks[chunk] && chunks[chunk]->is_live(slot)){
+                return &chunks[chunk]->values[slot];
+            }
+            return fallback.empty() ? nullptr : fallback.find(id);
+        }
+        const Value* find(OrderId id) const{
+            return const_cast<OrderTable*>(this)->find(id);
+        }
+        bool contains(OrderId id) const{ return find(id) != nullptr; }
+
+        // insert 'value' unless 'id' is present; the id's value and
+        // whether it was inserted
+        std::pair<Value*, bool> try_emplace(OrderId id, const Value& value){
+            if(Value* present = find(id)){
+                return {present, false};
+            }
+            size_t chunk, slot;
+            if(!locate(id, chunk, slot) && !(cover(id) && locate(id, chunk, slot))){
+                auto inserted = fallback.try_emplace(id, value);
+                peak = std::max(peak, size());
+                return inserted;
+            }
+            if(!chunks[chunk]){
+                chunks[chunk] = new_chunk();
+            }
+            Chunk& target = *chunks[chunk];
+            target.live[slot >> 6] |= 1ULL << (slot & 63);
+            ++target.count;
+            target.values[slot] = value;
+            ++direct_count;
+            peak = std::max(peak, size());
+            return {&target.values[slot], true};
+        }
+        void insert_or_assign(OrderId id, const Value& value){
+            auto entry = try_emplace(id, value);
+            if(!entry.second){
+                *entry.first = value;
+            }
+        }
+        bool erase(OrderId id){
+            size_t chunk, slot;
+            if(locate(id, chunk, slot) && chunks[chunk] && chunks[chunk]->is_live(slot)){
+                Chunk& target = *chunks[chunk];
+                target.live[slot >> 6] &= ~(1ULL << (slot & 63));
+                --direct_count;
+                if(--target.count == 0){
+                    release(chunks[chunk]);
+                    trim();
+                }
+                return true;
+            }
+            return !fallback.empty() && fallback.erase(id);
+        }
+
+        // keep chunks for 'orders' live orders once allocated, so that a
+        // window of that size is not released and allocated over and over
+        void reserve(size_t orders){
+            size_t wanted = static_cast<size_t>((orders + CHUNK_SIZE - 1) >> CHUNK_BITS);
+            spare_limit = std::max<size_t>(wanted, 1);
+            while(allocated < wanted){
+                spares.emplace_back(new Chunk);
+                ++allocated;
+            }
+        }
+
+        // number of ids in the fallback
+        size_t outliers() const{ return fallback.size(); }
+
+        // chunks count as slabs of CHUNK_SIZE slots, plus the fallback's
+        PoolStats get_stats() const{
+            PoolStats stats = fallback.get_stats();
+            stats.in_use = size();
+            stats.peak = peak;
+            stats.capacity += allocated * CHUNK_SIZE;
+            stats.slabs += allocated;
+            stats.bytes += allocated * sizeof(Chunk) + chunks.capacity() * sizeof(chunks[0]);
+            return stats;
+        }
+};
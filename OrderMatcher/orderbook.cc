@@ -1,119 +1,93 @@
 #include "orderbook.hh"
-#include <iterator>
 
 // private methods:
 
 /*
-    Update last buy/sell price after a match.
+    Add an order 'order' at price 'level' to the ladder 'levels'
 */
-void OrderBook::set_last_matching_price(Order& order, unsigned price){
-    if(order.isBuy()){
-        last_buy_price = price;
-    }else{
-        last_sell_price = price;
-    }
-}
-
-/*
-    Get last buy matching price.
-*/
-unsigned OrderBook::get_buy_market_price() const{
-    unsigned best_buy_price = buyprices.empty() ? 0 : *(buyprices.begin());
-    return std::max(best_buy_price,last_buy_price);
+template<typename Comp>
+StatusCode OrderBook::add_to_orderbook(Order& order, unsigned level, PriceLadder<Comp>& levels){
+    OrderSide side = order.get_side();
+    //add to relevant level, created if not found
+    unsigned cold = cold_orders.insert(order);
+    OrderNode* node = levels.push_back(level, order.get_id(), order.get_quantity(), cold, order.isAON());
+    //add to order map
+    OrderInfo info = {side, level, order.get_type(), node};
+    order_map.insert_or_assign(order.get_id(), info);
+    return StatusCode :: OK;
 }
 
 /*
-    Get last sell matching price.
+    Rest the stop order 'order' at its stop price.
 */
-unsigned OrderBook::get_sell_market_price() const{ // ?
-    unsigned best_sell_price = sellprices.empty() ? std::numeric_limits<unsigned>::max() : *(sellprices.begin());
-    return std::min(best_sell_price,last_sell_price);
+template<OrderSide Side>
+void OrderBook::rest_stop_order(Order& order){
+    BookSide<Side>& side = book_side<Side>();
+    add_to_orderbook(order, order.get_stop_price(), side.stops);
+    side.update_trigger();
 }
 
 /*
-    Add an order 'order' at price 'level' to level pool 'prices'
-    and order pool 'pool'
+    Whether the nearest stop of 'Side' is crossed.
 */
-template<typename Comp>
-StatusCode OrderBook::add_to_orderbook(Order& order, unsigned level, std::set<unsigned, Comp>& prices, std::unordered_map<unsigned, std::list<Order>>& pool){
-    OrderSide side = order.get_side();
-    if (pool.find(level) == pool.end()){ //price level not found
-            prices.insert(level);
-    }
-    //add to relevant pool
-    pool[level].push_back(order);
-    //add to order map
-    OrderInfo info = {side, level, order.get_type()};
-    order_map.insert_or_assign(order.get_id(), info);
-    return StatusCode :: OK;
+template<OrderSide Side>
+bool OrderBook::stop_fires() const{
+    const BookSide<Side>& side = book_side<Side>();
+    return !side.stops.empty() && side.stop_crossed(book_side<BookSide<Side>::opposite>().market_price());
 }
 
 /*
-    Execute/Activate all stop orders.
+    Execute/Activate all stop orders crossed by the market, nearest stop
+    price first. Fired orders may trade and cross further stops, so the
+    triggers are checked again after every level until no stop is crossed.
 */
 void OrderBook::execute_stop_orders(){
-    //std::cout << "Executing stop orders\n";
-    //if stop price at a level <= market price, stop order is activated
-    auto buy_pred = [](unsigned stop_price, unsigned sell_market_price) {
-     return stop_price <= sell_market_price;
-    };
-    
-    //execute stop buy orders if possible
-    execute_stop_orders(get_sell_market_price(), stop_buy_prices, stop_buy_pool, buy_pred);
-
-    //if stop price at a level >= market price, stop order is activated
-    auto sell_pred = [](unsigned stop_price, unsigned buy_market_price) {
-     return stop_price >= buy_market_price;
-    };
-    //execute stop sell orders if possible
-    execute_stop_orders(get_buy_market_price(), stop_sell_prices, stop_sell_pool, sell_pred);
+    while(true){
+        if(stop_fires<OrderSide::BUY>()){
+            execute_stop_level<OrderSide::BUY>();
+        }else if(stop_fires<OrderSide::SELL>()){
+            execute_stop_level<OrderSide::SELL>();
+        }else{
+            return;
+        }
+    }
 }
 
 /*
-    Execute stop orders present in 'order_pool' with price levels 'prices'
-    based on predicate 'p'
+    Take the nearest level off the stops of 'Side' and activate its orders
+    in time priority. The level's queue is moved out whole, its nodes are
+    not copied.
 */
-template<typename Pred, typename Comp>
-void OrderBook::execute_stop_orders(unsigned stop_price, std::set<unsigned,Comp>& prices,
-                                    std::unordered_map<unsigned, std::list<Order>>& order_pool, Pred p){
-    //For every stop price satisfying predicate, delete from stop pool and activate it
-     for (auto f = prices.begin(); f != prices.end();) {
-        //std::cout << "In loop to Executing stop orders at level " << *f <<" stop price " <<stop_price;
-        if(!p(*f, stop_price))
-            break;
-        //std::cout << "Executing stop orders at level " << *f << "\n";
-        std::list<Order> orders = order_pool[*f];
-        f = prices.erase(f);
-        order_pool.erase(*f);
-        //iterare through all orders at a price level
-        for(auto order : orders){
-            execute_stop_order(order, order.get_type() == OrderType::STOP_LIMIT);
-        }
-        //std::cout << "End of Executing stop orders at level " << *f << "\n";
-     }
+template<OrderSide Side>
+void OrderBook::execute_stop_level(){
+    BookSide<Side>& side = book_side<Side>();
+    OrderQueue orders = side.stops.take(side.stops.best());
+    side.update_trigger();
+    for(const OrderNode& node : orders){
+        Order order = cold_orders.make_order(node);
+        // activated orders re-enter order_map if they rest
+        order_map.erase(node.id);
+        departed.push_back(node.id);
+        cold_orders.release(node.cold);
+        execute_stop_order<Side>(order, order.get_type() == OrderType::STOP_LIMIT);
+    }
 }
 
 /*
     Execute a particular stop order 'order'.
     Convert it to Limit/Market order.
 */
+template<OrderSide Side>
 void OrderBook::execute_stop_order(Order& order, bool is_limit){
     if(is_limit){
         order.set_type(OrderType::LIMIT);
-        //std::cout << "setting to LO \n" << order;
     }else{
-        // std::cout << "setting to MO \n" << order;
         order.set_type(OrderType::MARKET);
         order.set_quote(0);
     }
-    match_order(order, !is_limit);
-    //std::cout << "Order qty " << order.get_quantity();
+    match_order<Side>(order, !is_limit);
     if (order.get_quantity() > 0){
-        if(order.isBuy()){
-            add_to_orderbook(order, order.get_quote(), buyprices, buypool);
-        }else{
-            add_to_orderbook(order, order.get_quote(), sellprices, sellpool);
-        }
+        add_to_orderbook(order, order.get_quote(), book_side<Side>().levels);
     }
 }
 
@@ -121,29 +95,13 @@ void OrderBook::execute_stop_order(Order& order, bool is_limit){
     Add stop order to the order book.
     Try to execute immediately if possible, else add it to the pool.
 */
+template<OrderSide Side>
 StatusCode OrderBook::add_stop_order(Order& order, bool is_limit){
-    bool can_execute;
-    unsigned stop_price = order.get_stop_price();
-    if(order.isBuy()){
-        auto market_price = get_sell_market_price();
-        //std::cout << "Buy Stop price = " << market_price;
-        can_execute = stop_price <= market_price;
+    unsigned market_price = book_side<BookSide<Side>::opposite>().market_price();
+    if(BookSide<Side>::crossed(order.get_stop_price(), market_price)){
+        execute_stop_order<Side>(order, is_limit);
     }else{
-        auto market_price = get_buy_market_price();
-        //std::cout << "Sell Stop price = " << market_price;
-        can_execute = stop_price >= market_price;
-    }
-    if(can_execute){
-        //std::cout << "Can execute stop order now, stop price = " << stop_price;
-        //execute stop order fn - set type to MO/LO - if remaining need to add to orderbook
-        execute_stop_order(order, is_limit);
-    }else{
-        //std::cout << "Cannot execute stop order now, adding to orderbook \n";
-        if(order.isBuy()){
-            add_to_orderbook(order, stop_price, stop_buy_prices, stop_buy_pool);
-        }else{
-            add_to_orderbook(order, stop_price, stop_sell_prices, stop_sell_pool);
-        }
+        rest_stop_order<Side>(order);
     }
     return StatusCode::OK;
 }
@@ -151,34 +109,53 @@ StatusCode OrderBook::add_stop_order(Order& order, bool is_limit){
 /*
     Fetch the OrderInfo from the order_map given order_id.
 */
-std::optional<OrderInfo> OrderBook::get_order_info(unsigned int order_id){
-    auto order = order_map.find(order_id);
-    if (order == order_map.end()){ 
+std::optional<OrderInfo> OrderBook::get_order_info(OrderId order_id){
+    const OrderInfo* info = order_map.find(order_id);
+    if (info == nullptr){
         return {};
     }
-    return order->second;
+    return *info;
 }
 
 /*
-    Delete an order with ID 'order_id' at price 'price' from the level pool 'prices'
-    and order pool 'pool'
+    Delete the order of 'info' from the ladder 'levels'
 */
 template<typename Comp>
-void OrderBook::delete_order(unsigned order_id, unsigned price, std::set<unsigned, Comp>& prices, 
-                            std::unordered_map<unsigned, std::list<Order>>& pool){
-    for (auto it = pool[price].begin(); it != pool[price].end(); ++it) {
-        if(it->get_id() == order_id){
-            pool[price].erase(it);
-            if(pool[price].empty()){ 
-                // std::cout << "Del from pool \n";
-                pool.erase(price);
-                prices.erase(price);  
-            }
-            break;
-        }
+void OrderBook::delete_order(const OrderInfo& info, PriceLadder<Comp>& levels){
+    cold_orders.release(info.node->cold);
+    levels.erase(info.price, *levels.find(info.price), info.node);
+}
+
+/*
+    Call 'f' with the ladder holding the order of 'info'.
+*/
+template<typename F>
+void OrderBook::with_levels(const OrderInfo& info, F f){
+    if(info.side == OrderSide::BUY){
+        with_levels<OrderSide::BUY>(info, f);
+    }else{
+        with_levels<OrderSide::SELL>(info, f);
     }
 }
 
+template<OrderSide Side, typename F>
+void OrderBook::with_levels(const OrderInfo& info, F f){
+    BookSide<Side>& side = book_side<Side>();
+    if((info.type == OrderType::STOP) || (info.type == OrderType::STOP_LIMIT)){
+        f(side.stops);
+        side.update_trigger();
+    }else{
+        f(side.levels);
+    }
+}
+
+/*
+    Delete the order of 'info' from whichever pool holds it.
+*/
+void OrderBook::remove_from_orderbook(const OrderInfo& info){
+    with_levels(info, [&](auto& levels){ delete_order(info, levels); });
+}
+
 
 // public:
 
@@ -186,109 +163,207 @@ void OrderBook::delete_order(unsigned order_id, unsigned price, std::set<unsigne
     Add an order to the order book.
 */
 StatusCode OrderBook::add_order(Order& order){
-   // std::cout << "In add order \n" << order;
-    unsigned order_id = order.get_id();
-    if(order_map.count(order_id) != 0){
+    if(order_map.contains(order.get_id())){
         return StatusCode :: ORDER_EXISTS;
     }
+    departed.clear();
+    StatusCode status = order.isBuy() ? add_order<OrderSide::BUY>(order) : add_order<OrderSide::SELL>(order);
+    // one comparison per side, unless a trade crossed a stop
+    if(mode == BookMode :: MATCHING && stops_crossed()){
+        execute_stop_orders();
+    }
+    return status;
+}
+
+/*
+    Add an order of 'Side' to the order book.
+*/
+template<OrderSide Side>
+StatusCode OrderBook::add_order(Order& order){
     StatusCode status = StatusCode :: OK;
     OrderType type = order.get_type();
-    if(type == OrderType :: MARKET || type == OrderType :: LIMIT ){
-        match_order(order, type == OrderType::MARKET);
+    BookSide<Side>& side = book_side<Side>();
+    if(mode == BookMode :: PASSIVE){
+        // already matched by the exchange: rest as is
+        bool isStop = type == OrderType :: STOP || type == OrderType :: STOP_LIMIT;
+        if(isStop){
+            rest_stop_order<Side>(order);
+        }else{
+            add_to_orderbook(order, order.get_quote(), side.levels);
+        }
+    } else if(type == OrderType :: MARKET || type == OrderType :: LIMIT ){
+        match_order<Side>(order, type == OrderType::MARKET);
         if (order.get_quantity() > 0){
-            //std::cout << "Adding to book" << order;
-            if(order.isBuy()){
-                add_to_orderbook(order, order.get_quote(), buyprices, buypool);
-            }else{
-                add_to_orderbook(order, order.get_quote(), sellprices, sellpool);
-            }
+            add_to_orderbook(order, order.get_quote(), side.levels);
         }
-        execute_stop_orders();  
     } else if(type == OrderType :: STOP){
-        status = add_stop_order(order,false);
+        status = add_stop_order<Side>(order,false);
     } else{
-        status = add_stop_order(order,true);
+        status = add_stop_order<Side>(order,true);
     }
-    return status; 
+    return status;
+}
+
+/*
+    Pre-allocate the pools, order_map and the cold table for 'orders'
+    resting orders and the bid and ask ladders for 'levels' price levels.
+*/
+void OrderBook::reserve(size_t orders, size_t levels){
+    order_nodes->reserve(orders);
+    order_map.reserve(orders);
+    cold_orders.reserve(orders);
+    bids.levels.reserve(levels);
+    asks.levels.reserve(levels);
 }
 
 /*
     Fetch an order with ID 'order_id'
 */
-std::optional<Order> OrderBook::get_order(unsigned int order_id){
-    //Fetch order info
-    auto order_details = get_order_info(order_id);
-    if (!order_details){
+std::optional<Order> OrderBook::get_order(OrderId order_id) const{
+    const OrderInfo* info = order_map.find(order_id);
+    if (info == nullptr){
         return {};
     }
-    auto order_info = *order_details;
-    bool isbuy = order_info.side==OrderSide::BUY;
-    bool isStop = (order_info.type == OrderType::STOP) || (order_info.type == OrderType::STOP_LIMIT);
-    unsigned price = order_info.price;
-    //Identify relevant pool to fetch order from
-    std::list<Order>& order_list = (isbuy) ? ((isStop)? stop_buy_pool[price] : buypool[price]) : 
-                                            ((isStop)? stop_sell_pool[price] : sellpool[price]);
-    for (auto it = order_list.begin(); it != order_list.end(); ++it) {
-        if(it->get_id() == order_id){
-            return *it;
-        }
-    }
-    return {};
+    return cold_orders.make_order(*info->node);
 }
 
 /*
     Delete an order with id 'order_id'
 */
-StatusCode OrderBook::delete_order(unsigned int order_id){
-    auto order_details = get_order_info(order_id);
-    if (!order_details){
+StatusCode OrderBook::delete_order(OrderId order_id){
+    const OrderInfo* info = order_map.find(order_id);
+    if (info == nullptr){
         return StatusCode :: ORDER_NOT_EXISTS;
     }
-    auto order_info = *order_details;
+    remove_from_orderbook(*info);
     order_map.erase(order_id);
-    bool isBuy = order_info.side==OrderSide::BUY;
-    bool isStop = (order_info.type == OrderType::STOP) || (order_info.type == OrderType::STOP_LIMIT);
-    if(isBuy){
-        if(isStop){
-            delete_order(order_id, order_info.price, stop_buy_prices, stop_buy_pool);
-        }else{
-            delete_order(order_id, order_info.price, buyprices, buypool);
-        }
+    return StatusCode :: OK;
+}
+
+/*
+    Take 'qty' shares off the order with id 'order_id', in place: it keeps
+    its position in the level's queue. Removes the order if nothing is left.
+*/
+StatusCode OrderBook::reduce_order(OrderId order_id, unsigned qty){
+    const OrderInfo* info = order_map.find(order_id);
+    if (info == nullptr){
+        return StatusCode :: ORDER_NOT_EXISTS;
+    }
+    if(info->node->quantity > qty){
+        with_levels(*info, [info, qty](auto& levels){ levels.reduce(*levels.find(info->price), info->node, qty); });
     }else{
-        if(isStop){
-            delete_order(order_id, order_info.price, stop_sell_prices, stop_sell_pool);
-        }else{
-            delete_order(order_id, order_info.price, sellprices, sellpool);
-        }
+        remove_from_orderbook(*info);
+        order_map.erase(order_id);
     }
-    return StatusCode :: OK;  
+    return StatusCode :: OK;
 }
 
 /*
- For debugging
+    Execute 'qty' shares of the resting order with id 'order_id'.
 */
-void OrderBook::printBuySellPool()const{
-    std::cout << "BuyPrices are:" << "\n";
-    for (auto const& price : buyprices)
-    {
-        std::cout << price << ' ';
+StatusCode OrderBook::execute_order(OrderId order_id, unsigned qty){
+    return reduce_order(order_id, qty);
+}
+
+/*
+    Replace order 'order_id' by order 'new_id' for 'qty' shares at 'price'.
+
+    Priority follows the usual exchange rule: an amend of the same id that
+    keeps the price and does not increase the size keeps the order's place
+    in the queue (it is a reduce); any other replace loses it, i.e. the
+    order joins the back of its (new) level as if it had just been added,
+    and in MATCHING mode may trade. A new id is a new order, so it always
+    goes to the back. A size of 0 just deletes the order.
+*/
+StatusCode OrderBook::replace_order(OrderId order_id, OrderId new_id, unsigned price, unsigned qty){
+    departed.clear();
+    const OrderInfo* order = order_map.find(order_id);
+    if (order == nullptr){
+        return StatusCode :: ORDER_NOT_EXISTS;
     }
-    std::cout << "\nBuyPool" << "\n";
-    for (auto const &pair: buypool) {
-        std::cout << "{" << pair.first << "}\n";
-        for (auto it = pair.second.begin(); it != pair.second.end(); ++it)
-            std::cout << ' ' << *it <<"}\n";
+    if (new_id != order_id && order_map.contains(new_id)){
+        return StatusCode :: ORDER_EXISTS;
     }
-    std::cout << "SellPrices are:" << "\n";
-    for (auto const& price : sellprices)
-    {
-        std::cout << price << ' ';
+    OrderInfo info = *order;
+    OrderNode& node = *info.node;
+    bool isStop = (info.type == OrderType::STOP) || (info.type == OrderType::STOP_LIMIT);
+    if(qty == 0){
+        return delete_order(order_id);
+    }
+    if(new_id == order_id && !isStop && price == info.price && qty <= node.quantity){
+        unsigned taken = node.quantity - qty;
+        with_levels(info, [&info, taken](auto& levels){ levels.reduce(*levels.find(info.price), info.node, taken); });
+        return StatusCode :: OK;
     }
-    std::cout << "\nSellPool" << "\n";
-    for (auto const &pair: sellpool) {
-        std::cout << "{" << pair.first << "}\n";
-        for (auto it = pair.second.begin(); it != pair.second.end(); ++it)
-            std::cout << ' ' << *it << "}\n";
+    const ColdOrder& cold = cold_orders[node.cold];
+    Order replacement(new_id, cold.owner, isStop ? cold.quote : price, isStop ? price : cold.stop_price,
+                      qty, cold.side, cold.type, node.aon);
+    remove_from_orderbook(info);
+    order_map.erase(order_id);
+    return add_order(replacement);
+}
+
+/*
+    Print the prices of 'levels', best first, then the orders of each level.
+*/
+template<typename Comp>
+static void print_levels(const PriceLadder<Comp>& levels, const ColdOrderTable& cold_orders, const char* pool_name){
+    if(!levels.empty()){
+        unsigned price = levels.best();
+        do{
+            std::cout << price << ' ';
+        }while(levels.next(price));
+    }
+    std::cout << "\n" << pool_name << "\n";
+    if(!levels.empty()){
+        unsigned price = levels.best();
+        do{
+            const OrderQueue& queue = *levels.find(price);
+            std::cout << "{" << price << ": " << queue.quantity() << " in " << queue.size() << "}\n";
+            for (const OrderNode& node : queue)
+                std::cout << ' ' << cold_orders.make_order(node) <<"}\n";
+        }while(levels.next(price));
+    }
+}
+
+/*
+    Size of the level at 'price' of 'levels'.
+*/
+template<typename Comp>
+static DepthSummary level_depth(const PriceLadder<Comp>& levels, unsigned price){
+    DepthSummary depth;
+    if(const OrderQueue* queue = levels.find(price)){
+        depth.quantity = queue->quantity();
+        depth.orders = queue->size();
+        depth.levels = 1;
+    }
+    return depth;
+}
+
+DepthSummary OrderBook::level_depth(OrderSide side, unsigned price) const{
+    return side == OrderSide::BUY ? ::level_depth(bids.levels, price) : ::level_depth(asks.levels, price);
+}
+
+DepthSummary OrderBook::side_depth(OrderSide side) const{
+    DepthSummary depth;
+    if(side == OrderSide::BUY){
+        depth = {bids.levels.quantity(), bids.levels.orders(), bids.levels.size()};
+    }else{
+        depth = {asks.levels.quantity(), asks.levels.orders(), asks.levels.size()};
     }
+    return depth;
+}
+
+size_t OrderBook::depth(OrderSide side, DepthLevel* out, size_t n) const{
+    return side == OrderSide::BUY ? bids.levels.depth(out, n) : asks.levels.depth(out, n);
 }
 
+/*
+ For debugging
+*/
+void OrderBook::printBuySellPool()const{
+    std::cout << "BuyPrices are:" << "\n";
+    print_levels(bids.levels, cold_orders, "BuyPool");
+    std::cout << "SellPrices are:" << "\n";
+    print_levels(asks.levels, cold_orders, "SellPool");
+}
@@ -2,14 +2,19 @@
 
 #include <array>
 #include <fstream>
-#include <list>
+#include <functional>
+#include <memory>
 #include <optional>
-#include <set>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "book_side.hh"
+#include "cold_orders.hh"
+#include "flat_hash_map.hh"
+#include "node_pool.hh"
 #include "order.hh"
+#include "order_queue.hh"
+#include "price_ladder.hh"
 
 enum StatusCode {
     OK,
@@ -20,66 +25,218 @@ enum StatusCode {
 
 };
 
+/*
+    MATCHING: adds are matched against the book and trigger stop orders,
+    fills are written to the per-symbol trade file.
+    PASSIVE: the book mirrors an exchange feed that already did the
+    matching; orders rest at their price as they come, nothing is matched,
+    no stop order is evaluated and no trade file is written.
+*/
+enum class BookMode : unsigned char {
+    MATCHING,
+    PASSIVE
+};
+
 struct OrderInfo{
     OrderSide side;
     unsigned price;
     OrderType type;
+    // the order in its level's queue
+    OrderNode* node;
+};
+
+/*
+    Resting limit orders at a price level, or on a whole side of a book,
+    and their remaining quantity.
+*/
+struct DepthSummary{
+    uint64_t quantity = 0;
+    size_t orders = 0;
+    size_t levels = 0;
 };
 
+/*
+    Top N levels of both sides of a book, best first: bids[0, bid_levels)
+    and asks[0, ask_levels).
+*/
+template<size_t N>
+struct DepthSnapshot{
+    size_t bid_levels = 0;
+    size_t ask_levels = 0;
+    std::array<DepthLevel, N> bids;
+    std::array<DepthLevel, N> asks;
+};
+
+/*
+    Slab pool utilisation of a book: order nodes, price level nodes (of the
+    ladders' fallback maps), the order lookup table's slots and the cold
+    order attributes.
+*/
+struct BookPoolStats{
+    PoolStats orders;
+    PoolStats levels;
+    PoolStats index;
+    PoolStats cold;
+
+    BookPoolStats& operator+=(const BookPoolStats& other){
+        orders += other.orders;
+        levels += other.levels;
+        index += other.index;
+        cold += other.cold;
+        return *this;
+    }
+    void print(std::ostream& out) const{
+        const std::pair<const char*, const PoolStats*> pools[] = {{"orders", &orders}, {"levels", &levels}, {"index", &index},
+                                                                  {"cold", &cold}};
+        out << "Pools:";
+        for(const auto& pool : pools){
+            out << " " << pool.first << " " << pool.second->in_use << "/" << pool.second->capacity
+                << " (peak " << pool.second->peak << ", " << pool.second->slabs << " slabs, "
+                << pool.second->bytes / 1024 << " KB)";
+        }
+        out << std::endl;
+    }
+};
+
+// key=order ID, value=(orderside, price level, ordertype, node)
+using OrderIndex = FlatHashMap<OrderId, OrderInfo>;
+
 /*
     The Order Book for a particular stock symbol.
+
+    Order nodes and price levels are allocated from the book's own slab
+    pools, order_map is a flat table; see reserve() and get_pool_stats().
 */
 class OrderBook{
 
     private:
-        unsigned last_buy_price = 0;
-        unsigned last_sell_price = std::numeric_limits<unsigned>::max();
         std::string company; // also the filename for output
+        BookMode mode;
         std::ofstream ostrm;
 
-        // key=price level; value=a list of Order
-        std::unordered_map<unsigned, std::list<Order>> buypool, sellpool, stop_buy_pool, stop_sell_pool; 
-        // stores current levels of the hashmaps (sellpool and stop_buy_pool)
-        std::set<unsigned, std::less<unsigned>> sellprices, stop_buy_prices;
-        // stores current levels of the hashmaps (buypool and stop_sell_pool)
-        std::set<unsigned, std::greater<unsigned>> buyprices, stop_sell_prices;
-        // key=order ID, value=(orderside, price level, ordertype)
-        std::unordered_map<unsigned, OrderInfo> order_map; 
-
-        unsigned get_sell_market_price() const;
-        unsigned get_buy_market_price() const;
-        void execute_stop_orders();
-        
-        template<typename Pred, typename Comp>
-        void execute_stop_orders(unsigned, std::set<unsigned, Comp>&, std::unordered_map<unsigned, std::list<Order>>&, Pred);
-        
-        void execute_stop_order(Order&, bool);
+        // slab pools of order nodes and price levels; they back the
+        // containers below, so they are declared first; the PoolAllocators
+        // handed to the ladders and order_map keep their addresses, which
+        // must stay put for as long as the book lives
+        std::unique_ptr<PoolArena> order_arena = std::make_unique<PoolArena>();
+        std::unique_ptr<PoolArena> level_arena = std::make_unique<PoolArena>();
+        SlabPool* order_nodes = &order_arena->pool(sizeof(OrderNode));
+
+        // price grid of the ladders' dense windows
+        unsigned tick;
+        // resting and stop orders of each side
+        BookSide<OrderSide::BUY> bids{order_nodes, level_arena.get(), tick};
+        BookSide<OrderSide::SELL> asks{order_nodes, level_arena.get(), tick};
+        // key=order ID, value=(orderside, price level, ordertype, node)
+        OrderIndex order_map;
+        // cold attributes of the resting orders, by OrderNode::cold
+        ColdOrderTable cold_orders;
+        // ids that left the book by trading away or firing as stops during
+        // the last add or replace; only MATCHING mode fills it
+        std::vector<OrderId> departed;
+
+        template<OrderSide Side>
+        BookSide<Side>& book_side(){
+            if constexpr (Side == OrderSide::BUY){ return bids; } else { return asks; }
+        }
+        template<OrderSide Side>
+        const BookSide<Side>& book_side() const{
+            if constexpr (Side == OrderSide::BUY){ return bids; } else { return asks; }
+        }
+
+        /*
+            Matching, adding and stop handling below are instantiated once
+            per side of the incoming order; add_order() picks the side.
+        */
+        template<OrderSide Side>
+        StatusCode add_order(Order&);
+        template<OrderSide Side>
         void match_order(Order& order);
+        template<OrderSide Side>
         void match_order(Order& order, bool isMarket);
+        template<OrderSide Side>
         StatusCode add_stop_order(Order&, bool);
-        std::optional<OrderInfo> get_order_info(unsigned int);
+        template<OrderSide Side>
+        void rest_stop_order(Order&);
+        template<OrderSide Side>
+        void execute_stop_order(Order&, bool);
+        // whether a stop of 'Side' is crossed, exactly
+        template<OrderSide Side>
+        bool stop_fires() const;
+        template<OrderSide Side>
+        void execute_stop_level();
+        // whether a stop may be crossed at the current market prices
+        bool stops_crossed() const{
+            return bids.stop_crossed(asks.market_price()) || asks.stop_crossed(bids.market_price());
+        }
+        void execute_stop_orders();
+
+        std::optional<OrderInfo> get_order_info(OrderId);
         
         template<typename Comp>
-        StatusCode add_to_orderbook(Order& order, unsigned level, std::set<unsigned, Comp>& prices, std::unordered_map<unsigned, std::list<Order>>& pool);
+        StatusCode add_to_orderbook(Order& order, unsigned level, PriceLadder<Comp>& levels);
         
         template<typename Comp>
-        void delete_order(unsigned, unsigned, std::set<unsigned, Comp>& prices, std::unordered_map<unsigned, std::list<Order>>& pool);
-        
-        void set_last_matching_price(Order& order, unsigned price);
+        void delete_order(const OrderInfo&, PriceLadder<Comp>& levels);
+        void remove_from_orderbook(const OrderInfo&);
+        // call 'f' with the ladder holding the order of 'info'
+        template<typename F>
+        void with_levels(const OrderInfo& info, F f);
+        template<OrderSide Side, typename F>
+        void with_levels(const OrderInfo& info, F f);
 
     public:
-        OrderBook(std::string company = "default") :
+        // ITCH prices have four decimals, so this is one cent
+        static constexpr unsigned DEFAULT_TICK = 100;
+
+        OrderBook(std::string company = "default", BookMode mode = BookMode::MATCHING, unsigned tick = DEFAULT_TICK) :
             company(company),
-            ostrm("./output/" + company, std::ios_base::trunc)
+            mode(mode),
+            ostrm(mode == BookMode::MATCHING ? std::ofstream("./output/" + company, std::ios_base::trunc) : std::ofstream()),
+            tick(tick)
             {}
         StatusCode add_order(Order&);
-        std::optional<Order> get_order(unsigned int);
-        StatusCode delete_order(unsigned int);
+        // pre-allocate room for 'orders' resting orders and 'levels' price
+        // levels per side, so that a book of that size never calls malloc
+        void reserve(size_t orders, size_t levels);
+        // utilisation of the book's slab pools
+        BookPoolStats get_pool_stats() const{
+            return {order_arena->get_stats(), level_arena->get_stats(), order_map.get_stats(), cold_orders.get_stats()};
+        }
+        // take 'qty' shares off a resting order in place, keeping its queue
+        // priority (ITCH X); the order leaves the book once nothing is left
+        StatusCode reduce_order(OrderId, unsigned);
+        // 'qty' shares of a resting order were executed (ITCH E/C)
+        StatusCode execute_order(OrderId, unsigned);
+        // replace an order by 'new_id' at 'price' for 'qty' shares (ITCH U,
+        // or an amend when the ids are equal); see orderbook.cc for priority
+        StatusCode replace_order(OrderId, OrderId, unsigned, unsigned);
+        bool has_order(OrderId order_id) const{ return order_map.contains(order_id); }
+        // orders that traded away or fired during the last add_order() or
+        // replace_order(); a fired stop that rests again is has_order()
+        const std::vector<OrderId>& departed_orders() const{ return departed; }
+        BookMode get_mode() const{ return mode; }
+        // a copy of the resting order, none if there is none
+        std::optional<Order> get_order(OrderId) const;
+        StatusCode delete_order(OrderId);
         unsigned best_ask()const{
-            return sellprices.empty() ? std::numeric_limits<unsigned>::max() : *(sellprices.begin()); 
+            return asks.best();
         }
         unsigned best_bid()const{
-            return buyprices.empty() ? 0 : *(buyprices.begin());
+            return bids.best();
+        }
+        // resting limit orders at 'price' on 'side', in O(1)
+        DepthSummary level_depth(OrderSide side, unsigned price) const;
+        // all resting limit orders of 'side', in O(1)
+        DepthSummary side_depth(OrderSide side) const;
+        // fill 'out' with up to 'n' levels of 'side', best first, without
+        // allocating; returns how many. The top PriceLadder::TOP_LEVELS
+        // levels are cached, deeper ones cost a ladder walk
+        size_t depth(OrderSide side, DepthLevel* out, size_t n) const;
+        template<size_t N>
+        void snapshot(DepthSnapshot<N>& out) const{
+            out.bid_levels = depth(OrderSide::BUY, out.bids.data(), N);
+            out.ask_levels = depth(OrderSide::SELL, out.asks.data(), N);
         }
         void printBuySellPool()const;
 };
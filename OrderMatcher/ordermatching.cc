@@ -3,75 +3,79 @@
 #include "orderbook.hh"
 
 // private:
+/*
+    Match 'order', a limit order of 'Side', against the other side of the
+    book. The side is a template parameter, so the loop below has no side
+    tests: the ladder, the price ordering and the trade's buyer and seller
+    are fixed at compile time.
+*/
+template<OrderSide Side>
 void OrderBook::match_order(Order& order){ // assume limit order
-    bool isbuy = order.get_side()==OrderSide::BUY;
+    constexpr OrderSide Opposite = BookSide<Side>::opposite;
+    BookSide<Opposite>& other = book_side<Opposite>();
+    auto quote = order.get_quote();
     if(order.isAON()){
         auto qty = order.get_quantity();
-        decltype(qty) fulfillment = 0;
-        auto quote = order.get_quote();
-        auto iter = isbuy ? sellprices.begin() : buyprices.begin();
-        auto iterend = isbuy ? std::upper_bound(sellprices.begin(), sellprices.end(), quote) : std::upper_bound(buyprices.begin(), buyprices.end(), quote, std::greater<unsigned>());
-        for(; qty<fulfillment && iter!=iterend; ++iter){
-            auto &nowlist = isbuy ? sellpool[*iter] : buypool[*iter];
-            for(auto &noworder : nowlist){
-                fulfillment += noworder.get_quantity();
-            }
+        uint64_t fulfillment = 0;
+        // sum the levels from the best one up to the quote, until enough
+        bool more = !other.levels.empty();
+        for(unsigned price = more ? other.levels.best() : 0;
+            fulfillment<qty && more && BookSide<Opposite>::reaches(quote, price); more = other.levels.next(price)){
+            fulfillment += other.levels.find(price)->quantity();
         }
-        if(qty < fulfillment){return;}
+        if(fulfillment < qty){return;}
     }
-    while(!(isbuy ? sellprices.empty() : buyprices.empty())){
-        auto level = isbuy ? best_ask() : best_bid();
-        if(isbuy ? order.get_quote() < level : order.get_quote() > level){
+    while(!other.levels.empty()){
+        auto level = other.levels.best();
+        if(!BookSide<Opposite>::reaches(quote, level)){
             return;
         }
-        auto &nowlist = isbuy ? sellpool[level] : buypool[level];
+        OrderQueue &nowlist = *other.levels.find(level);
         while(!nowlist.empty()){
-            auto &noworder = nowlist.front();
-            auto quantity = std::min(noworder.get_quantity(), order.get_quantity());
-            if(noworder.isAON() && noworder.get_quantity() > order.get_quantity()){
+            OrderNode &noworder = nowlist.front();
+            auto quantity = std::min(noworder.quantity, order.get_quantity());
+            if(noworder.aon && noworder.quantity > order.get_quantity()){
                 return;
             }
-            
+
             // execute the order
-            ostrm << (isbuy?order.get_id():noworder.get_id()) << ";" <<
-                (isbuy?noworder.get_id():order.get_id()) << ";" <<
+            ostrm << (Side == OrderSide::BUY ? order.get_id() : noworder.id) << ";" <<
+                (Side == OrderSide::BUY ? noworder.id : order.get_id()) << ";" <<
                 level << ";" << quantity << "\n";
             // result.push_back(Transaction(isbuy?order.get_id():noworder.get_id(), isbuy?noworder.get_id():order.get_id(), level, quantity));
-            noworder.reduce_quantity(quantity);
+            other.levels.reduce(nowlist, &noworder, quantity);
             //update matching price
-            set_last_matching_price(noworder, level);
-            if(noworder.get_quantity()==0){
-                order_map.erase(noworder.get_id());
-                nowlist.pop_front();
-                if(nowlist.empty()){
-                    if(isbuy){
-                        sellpool.erase(level);
-                        sellprices.erase(level);
-                    }else{
-                        buypool.erase(level);
-                        buyprices.erase(level);
-                    }
-                }
-            }
+            other.last_price = level;
             order.reduce_quantity(quantity);
+            bool level_cleared = false;
+            if(noworder.quantity==0){
+                order_map.erase(noworder.id);
+                departed.push_back(noworder.id);
+                cold_orders.release(noworder.cold);
+                // nowlist is destroyed with its level once empty
+                level_cleared = other.levels.erase(level, nowlist, &noworder);
+            }
             if(order.get_quantity()==0){
                 // the caller needs to delete this entry from pool similar to noworder
                 return;
             }
+            if(level_cleared){
+                break;
+            }
         }
     }
     return;
 }
 
 
+template<OrderSide Side>
 void OrderBook::match_order(Order& order, bool isMarket){
     // Made minor change of passing boolean to prevent repeating same code in multiple places
     if(isMarket){
-        if(order.get_side()==OrderSide::BUY){
-            order.set_quote(best_ask());
-        }else if(order.get_side()==OrderSide::SELL){
-            order.set_quote(best_bid());
-        }
+        order.set_quote(book_side<BookSide<Side>::opposite>().best());
     }
-    match_order(order);
-}
\ No newline at end of file
+    match_order<Side>(order);
+}
+
+template void OrderBook::match_order<OrderSide::BUY>(Order&, bool);
+template void OrderBook::match_order<OrderSide::SELL>(Order&, bool);
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "node_pool.hh"
+#include "order_queue.hh"
+
+// one price level of a depth snapshot
+struct DepthLevel{
+    unsigned price;
+    unsigned orders;
+    uint64_t quantity;
+};
+
+/*
+    The price levels of one side of a book, best first by 'Comp'
+    (std::greater for bids, std::less for asks).
+
+    Levels on the tick grid near the market live in a dense window of
+    slots, one per tick, starting at price 'base'. A two-level occupancy
+    bitmap (one bit per slot, one summary bit per 64 slots) finds the best
+    or next level with a couple of count-trailing/leading-zero instructions.
+    The window grows and recenters as prices drift; levels off the grid or
+    too far from the market to share the window go to an ordered fallback
+    map. A price is in exactly one of the two.
+
+    The ladder also keeps the order count and quantity of the whole side,
+    as long as orders come, go and shrink through its push_back, erase and
+    reduce rather than through the queues themselves.
+
+    The prices of the best TOP_LEVELS levels are cached for depth
+    snapshots. A new or removed level only touches the cache if it is
+    inside it; a removal leaves the cache short, and the next snapshot
+    refills it from the ladder.
+*/
+template<typename Comp>
+class PriceLadder{
+    public:
+        static constexpr unsigned MIN_WINDOW = 64;
+        static constexpr unsigned MAX_WINDOW = 64 * 64; // one summary word
+        static constexpr unsigned TOP_LEVELS = 20;
+
+    private:
+        static constexpr bool ascending = std::is_same<Comp, std::less<unsigned>>::value;
+        static_assert(ascending || std::is_same<Comp, std::greater<unsigned>>::value, "bids or asks");
+        static constexpr unsigned NONE = ~0u;
+
+        using Fallback = std::map<unsigned, OrderQueue, Comp, PoolAllocator<std::pair<const unsigned, OrderQueue>>>;
+
+        SlabPool* nodes;
+        unsigned tick;
+        unsigned base = 0;
+        std::vector<OrderQueue> slots;
+        std::vector<uint64_t> words;
+        uint64_t summary = 0;
+        size_t dense_count = 0;
+        Fallback fallback;
+        size_t side_orders = 0;
+        uint64_t side_quantity = 0;
+        // best levels first; always the best 'top_count' levels of the
+        // ladder, with the rest of them missing if the cache is short
+        mutable std::array<unsigned, TOP_LEVELS> top;
+        mutable unsigned top_count = 0;
+
+        // slot of 'price' if it is on the window's grid, else NONE
+        unsigned slot_of(unsigned price) const{
+            if(price < base || (price - base) % tick != 0){
+                return NONE;
+            }
+            unsigned slot = (price - base) / tick;
+            return slot < slots.size() ? slot : NONE;
+        }
+        unsigned price_of(unsigned slot) const{ return base + slot * tick; }
+        bool occupied(unsigned slot) const{ return (words[slot >> 6] >> (slot & 63)) & 1; }
+        void set(unsigned slot){
+            words[slot >> 6] |= 1ULL << (slot & 63);
+            summary |= 1ULL << (slot >> 6);
+            ++dense_count;
+        }
+        void reset(unsigned slot){
+            words[slot >> 6] &= ~(1ULL << (slot & 63));
+            if(words[slot >> 6] == 0){
+                summary &= ~(1ULL << (slot >> 6));
+            }
+            --dense_count;
+        }
+
+        // lowest occupied slot >= 'slot', NONE if there is none
+        unsigned scan_up(unsigned slot) const{
+            if(slot >= slots.size()){
+                return NONE;
+            }
+            unsigned word = slot >> 6;
+            uint64_t bits = words[word] & (~0ULL << (slot & 63));
+            if(bits){
+                return (word << 6) + __builtin_ctzll(bits);
+            }
+            uint64_t higher = word == 63 ? 0 : summary & (~0ULL << (word + 1));
+            if(!higher){
+                return NONE;
+            }
+            word = __builtin_ctzll(higher);
+            return (word << 6) + __builtin_ctzll(words[word]);
+        }
+        // highest occupied slot <= 'slot', NONE if there is none
+        unsigned scan_down(unsigned slot) const{
+            if(slots.empty()){
+                return NONE;
+            }
+            slot = std::min<unsigned>(slot, slots.size() - 1);
+            unsigned word = slot >> 6;
+            uint64_t bits = words[word] & (~0ULL >> (63 - (slot & 63)));
+            if(bits){
+                return (word << 6) + 63 - __builtin_clzll(bits);
+            }
+            uint64_t lower = summary & ((1ULL << word) - 1);
+            if(!lower){
+                return NONE;
+            }
+            word = 63 - __builtin_clzll(lower);
+            return (word << 6) + 63 - __builtin_clzll(words[word]);
+        }
+        unsigned dense_best() const{ return ascending ? scan_up(0) : scan_down(MAX_WINDOW); }
+        unsigned dense_worst() const{ return ascending ? scan_down(MAX_WINDOW) : scan_up(0); }
+
+        // a level at 'price' was added to a ladder of 'levels' levels
+        void top_insert(unsigned price, size_t levels){
+            unsigned n = top_count;
+            if(n == 0 || !Comp()(price, top[n - 1])){
+                // behind the cache: only a cache holding every level takes it
+                if(n < TOP_LEVELS && levels == n){
+                    top[top_count++] = price;
+                }
+                return;
+            }
+            unsigned i = 0;
+            while(!Comp()(price, top[i])){
+                ++i;
+            }
+            n = std::min(n, TOP_LEVELS - 1);
+            std::copy_backward(top.begin() + i, top.begin() + n, top.begin() + n + 1);
+            top[i] = price;
+            top_count = n + 1;
+        }
+        // the level at 'price' was removed
+        void top_erase(unsigned price){
+            unsigned n = top_count;
+            if(n == 0 || Comp()(top[n - 1], price)){
+                return;
+            }
+            unsigned i = 0;
+            while(i < n && top[i] != price){
+                ++i;
+            }
+            if(i < n){
+                std::copy(top.begin() + i + 1, top.begin() + n, top.begin() + i);
+                --top_count;
+            }
+        }
+        // make the cache hold min(TOP_LEVELS, size()) levels again
+        void top_refill() const{
+            unsigned wanted = static_cast<unsigned>(std::min<size_t>(TOP_LEVELS, size()));
+            if(top_count == 0 && wanted > 0){
+                top[top_count++] = best();
+            }
+            while(top_count < wanted){
+                unsigned price = top[top_count - 1];
+                next(price);
+                top[top_count++] = price;
+            }
+        }
+
+        // better of two prices of which either may be NONE
+        static unsigned better(unsigned a, unsigned b){
+            if(a == NONE || b == NONE){
+                return a == NONE ? b : a;
+            }
+            return Comp()(a, b) ? a : b;
+        }
+
+        /*
+            Move the window to 'window' slots from 'new_base': dense levels
+            outside it go to the fallback map, fallback levels on its grid
+            come in. Queues move, their orders stay where they are.
+        */
+        void rebuild(unsigned new_base, unsigned window){
+            std::vector<OrderQueue> old_slots;
+            old_slots.swap(slots);
+            std::vector<uint64_t> old_words;
+            old_words.swap(words);
+            unsigned old_base = base;
+
+            base = new_base;
+            slots.reserve(window);
+            for(unsigned slot = 0; slot < window; ++slot){
+                slots.emplace_back(nodes);
+            }
+            words.assign(window / 64, 0);
+            summary = 0;
+            dense_count = 0;
+
+            for(unsigned word = 0; word < old_words.size(); ++word){
+                for(uint64_t bits = old_words[word]; bits; bits &= bits - 1){
+                    unsigned old_slot = (word << 6) + __builtin_ctzll(bits);
+                    unsigned price = old_base + old_slot * tick;
+                    unsigned slot = slot_of(price);
+                    if(slot != NONE){
+                        slots[slot] = std::move(old_slots[old_slot]);
+                        set(slot);
+                    }else{
+                        fallback.emplace(price, std::move(old_slots[old_slot]));
+                    }
+                }
+            }
+            for(auto level = fallback.begin(); level != fallback.end();){
+                unsigned slot = slot_of(level->first);
+                if(slot != NONE){
+                    slots[slot] = std::move(level->second);
+                    set(slot);
+                    level = fallback.erase(level);
+                }else{
+                    ++level;
+                }
+            }
+        }
+        // window of 'window' slots with the grid prices 'low'..'high' in the middle
+        void center(unsigned low, unsigned high, unsigned window){
+            unsigned low_tick = low / tick;
+            unsigned slack = window - (high / tick - low_tick + 1);
+            unsigned first = low_tick > slack / 2 ? low_tick - slack / 2 : 0;
+            rebuild(first * tick, window);
+        }
+        /*
+            Make room in the window for grid price 'price'. It fits if the
+            window can grow to span it and every dense level; otherwise the
+            window recenters between it and the best level, leaving distant
+            levels to the fallback map, unless 'price' itself is the outlier.
+        */
+        bool make_room(unsigned price){
+            if(dense_count == 0){
+                center(price, price, std::max<unsigned>(slots.size(), MIN_WINDOW));
+                return true;
+            }
+            unsigned best_slot = dense_best(), worst_slot = dense_worst();
+            unsigned low = std::min({price, price_of(best_slot), price_of(worst_slot)});
+            unsigned high = std::max({price, price_of(best_slot), price_of(worst_slot)});
+            unsigned span = (high - low) / tick + 1;
+            if(span <= MAX_WINDOW / 2){
+                unsigned window = std::max<unsigned>(slots.size(), MIN_WINDOW);
+                while(window < 2 * span){
+                    window *= 2;
+                }
+                center(low, high, window);
+                return true;
+            }
+            unsigned best_price = best();
+            unsigned distance = (price > best_price ? price - best_price : best_price - price) / tick;
+            if(distance < MAX_WINDOW / 2){
+                center(std::min(price, best_price), std::max(price, best_price), MAX_WINDOW);
+                return true;
+            }
+            return false;
+        }
+        // queue of the level at 'price', created if needed, leaving the
+        // top cache alone; true if created
+        std::pair<OrderQueue*, bool> emplace_level(unsigned price){
+            unsigned slot = slot_of(price);
+            if(slot == NONE && price % tick == 0 && fallback.count(price) == 0 && make_room(price)){
+                slot = slot_of(price);
+            }
+            if(slot != NONE){
+                if(occupied(slot)){
+                    return {&slots[slot], false};
+                }
+                set(slot);
+                return {&slots[slot], true};
+            }
+            auto level = fallback.try_emplace(price, nodes);
+            return {&level.first->second, level.second};
+        }
+
+    public:
+        /*
+            @param nodes pool of the order nodes of every level's queue.
+            @param arena pool of the fallback map's nodes.
+            @param tick price grid of the dense window, in price units.
+        */
+        PriceLadder(SlabPool* nodes, PoolArena* arena, unsigned tick) :
+            nodes(nodes),
+            tick(std::max(tick, 1u)),
+            fallback(typename Fallback::allocator_type(arena))
+            {}
+        PriceLadder(const PriceLadder&) = delete;
+        PriceLadder& operator=(const PriceLadder&) = delete;
+
+        bool empty() const{ return dense_count == 0 && fallback.empty(); }
+        size_t size() const{ return dense_count + fallback.size(); }
+        // resting orders and their remaining quantity, over all levels
+        size_t orders() const{ return side_orders; }
+        uint64_t quantity() const{ return side_quantity; }
+        // number of levels in the fallback map
+        size_t outliers() const{ return fallback.size(); }
+
+        // best price; the ladder must not be empty
+        unsigned best() const{
+            unsigned slot = dense_best();
+            return better(slot == NONE ? NONE : price_of(slot), fallback.empty() ? NONE : fallback.begin()->first);
+        }
+        // move 'price' to the next level after it in priority order; false
+        // if there is none
+        bool next(unsigned& price) const{
+            unsigned slot;
+            if(ascending){
+                slot = price < base ? scan_up(0) : scan_up((price - base) / tick + 1);
+            }else{
+                slot = price <= base ? NONE : scan_down((price - base - 1) / tick);
+            }
+            auto level = fallback.upper_bound(price);
+            unsigned next = better(slot == NONE ? NONE : price_of(slot), level == fallback.end() ? NONE : level->first);
+            if(next == NONE){
+                return false;
+            }
+            price = next;
+            return true;
+        }
+
+        // queue of the level at 'price', nullptr if there is none
+        OrderQueue* find(unsigned price){
+            unsigned slot = slot_of(price);
+            if(slot != NONE){
+                return occupied(slot) ? &slots[slot] : nullptr;
+            }
+            auto level = fallback.find(price);
+            return level == fallback.end() ? nullptr : &level->second;
+        }
+        const OrderQueue* find(unsigned price) const{
+            return const_cast<PriceLadder*>(this)->find(price);
+        }
+        // queue of the level at 'price', created if needed; true if created
+        std::pair<OrderQueue*, bool> try_emplace(unsigned price){
+            std::pair<OrderQueue*, bool> level = emplace_level(price);
+            if(level.second){
+                top_insert(price, size() - 1);
+            }
+            return level;
+        }
+        // append an order to the level at 'price', created if needed
+        OrderNode* push_back(unsigned price, OrderId id, unsigned quantity, unsigned cold, bool aon){
+            ++side_orders;
+            side_quantity += quantity;
+            return try_emplace(price).first->push_back(id, quantity, cold, aon);
+        }
+        // take 'qty' shares off 'node' of 'queue', a level of this ladder
+        void reduce(OrderQueue& queue, OrderNode* node, unsigned qty){
+            side_quantity -= qty;
+            queue.reduce(node, qty);
+        }
+        // remove 'node' from 'queue', the level at 'price', and the level
+        // once it is empty; true if it was
+        bool erase(unsigned price, OrderQueue& queue, OrderNode* node){
+            --side_orders;
+            side_quantity -= node->quantity;
+            queue.erase(node);
+            if(queue.empty()){
+                erase(price);
+                return true;
+            }
+            return false;
+        }
+        // remove the level at 'price' and any order left in it
+        void erase(unsigned price){
+            OrderQueue* queue = find(price);
+            if(queue == nullptr){
+                return;
+            }
+            side_orders -= queue->size();
+            side_quantity -= queue->quantity();
+            top_erase(price);
+            unsigned slot = slot_of(price);
+            if(slot != NONE){
+                slots[slot].clear();
+                reset(slot);
+            }else{
+                fallback.erase(price);
+            }
+        }
+        // remove the level at 'price' and hand over its orders
+        OrderQueue take(unsigned price){
+            OrderQueue queue = std::move(*find(price));
+            side_orders -= queue.size();
+            side_quantity -= queue.quantity();
+            erase(price);
+            return queue;
+        }
+        /*
+            Fill 'out' with up to 'n' levels, best first; returns how many.
+            The first TOP_LEVELS come from the cache, deeper ones from
+            walking the ladder.
+        */
+        size_t depth(DepthLevel* out, size_t n) const{
+            top_refill();
+            size_t count = std::min<size_t>(n, top_count);
+            for(size_t i = 0; i < count; ++i){
+                const OrderQueue* queue = find(top[i]);
+                out[i] = {top[i], static_cast<unsigned>(queue->size()), queue->quantity()};
+            }
+            if(count > 0 && count == top_count){
+                // past the cache
+                for(unsigned price = top[count - 1]; count < n && next(price); ++count){
+                    const OrderQueue* queue = find(price);
+                    out[count] = {price, static_cast<unsigned>(queue->size()), queue->quantity()};
+                }
+            }
+            return count;
+        }
+        // allocate a window of at least 'levels' slots up front
+        void reserve(size_t levels){
+            unsigned window = std::max<unsigned>(slots.size(), MIN_WINDOW);
+            while(window < levels && window < MAX_WINDOW){
+                window *= 2;
+            }
+            if(window > slots.size()){
+                rebuild(base, window);
+            }
+        }
+};
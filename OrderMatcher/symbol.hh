@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/*
+    A stock symbol packed into one integer: the 8-byte, space padded form
+    used by ITCH, read as a native integer. Books can be found by symbol
+    with a single integer compare/hash and no string construction.
+*/
+using SymbolKey = uint64_t;
+
+inline SymbolKey make_symbol_key(std::string_view symbol){
+    char bytes[8] = {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '};
+    std::memcpy(bytes, symbol.data(), symbol.size() < 8 ? symbol.size() : 8);
+    SymbolKey key;
+    std::memcpy(&key, bytes, 8);
+    return key;
+}
+
+inline std::string symbol_name(SymbolKey key){
+    char bytes[8];
+    std::memcpy(bytes, &key, 8);
+    size_t n = 8;
+    while (n > 0 && bytes[n - 1] == ' ') --n;
+    return std::string(bytes, n);
+}
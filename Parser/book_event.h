@@ -0,0 +1,88 @@
+#ifndef ORDER_MATCHING_ENGINE_BOOK_EVENT_H
+#define ORDER_MATCHING_ENGINE_BOOK_EVENT_H
+
+#include <cstdint>
+#include "itch_dispatch.h"
+
+/**
+ * Fixed-width, native-endian form of the ITCH messages that affect a book.
+ *
+ * Decoding a frame into a BookEvent copies the few fields the book needs
+ * out of the frame, so the event can outlive the reader's buffer (e.g. be
+ * queued to another thread).
+ */
+struct BookEvent{
+    uint64_t timestamp = 0;
+    uint64_t orderRef = 0;
+    uint64_t newOrderRef = 0;   // 'U': reference of the replacing order
+    uint64_t stock = 0;         // 'A', 'F', 'R': packed 8-byte ticker
+    uint32_t shares = 0;        // added/executed/cancelled/replacing shares
+    uint32_t price = 0;
+    uint16_t stockLocate = 0;
+    char type = 0;              // ITCH message type
+    char side = 0;              // 'B' or 'S'
+};
+
+/**
+ * ITCH handler filling a BookEvent; see itch::dispatch.
+ */
+struct BookEventDecoder{
+    BookEvent &event;
+
+    void header(const itch::View &view){
+        event.type = view.type();
+        event.stockLocate = view.stockLocate();
+        event.timestamp = view.timestamp();
+    }
+    void on(const itch::StockDirectoryView &directory){
+        header(directory);
+        event.stock = directory.stock().key();
+    }
+    // 'A' and 'F'
+    void on(const itch::AddOrderView &add){
+        header(add);
+        event.orderRef = add.orderRef();
+        event.side = add.side();
+        event.shares = add.shares();
+        event.stock = add.stock().key();
+        event.price = add.price();
+    }
+    // 'E' and 'C'
+    void on(const itch::OrderExecutedView &executed){
+        header(executed);
+        event.orderRef = executed.orderRef();
+        event.shares = executed.executedShares();
+    }
+    void on(const itch::OrderExecutedWithPriceView &executed){
+        on(static_cast<const itch::OrderExecutedView &>(executed));
+        event.price = executed.executionPrice();
+    }
+    void on(const itch::OrderCancelView &cancel){
+        header(cancel);
+        event.orderRef = cancel.orderRef();
+        event.shares = cancel.cancelledShares();
+    }
+    void on(const itch::OrderDeleteView &del){
+        header(del);
+        event.orderRef = del.orderRef();
+    }
+    void on(const itch::OrderReplaceView &replace){
+        header(replace);
+        event.orderRef = replace.originalOrderRef();
+        event.newOrderRef = replace.newOrderRef();
+        event.shares = replace.shares();
+        event.price = replace.price();
+    }
+};
+
+/**
+ * Decodes 'frame' into 'event'.
+ *
+ * @return false if the frame does not affect a book.
+ */
+inline bool decodeBookEvent(const char *frame, uint16_t length, BookEvent &event){
+    BookEventDecoder decoder{event};
+    return itch::dispatch(decoder, frame, length);
+}
+
+#endif //ORDER_MATCHING_ENGINE_BOOK_EVENT_H
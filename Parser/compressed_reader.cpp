@@ -0,0 +1,264 @@
+#include "compressed_reader.h"
+
+#include <cstdio>
+#include <zlib.h>
+#ifdef ORDER_MATCHING_ENGINE_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+Compression detectCompression(const std::string &fileName){
+    unsigned char magic[4] = {0, 0, 0, 0};
+    std::ifstream file(fileName, std::ios::binary);
+    file.read(reinterpret_cast<char *>(magic), 4);
+    if (file.gcount() >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return Compression::GZIP;
+    }
+    if (file.gcount() == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return Compression::ZSTD;
+    }
+    return Compression::NONE;
+}
+
+CompressedReader::CompressedReader(std::string _fileName, Compression _compression,
+                                   size_t chunkSize, size_t chunkCount) :
+        Reader(std::move(_fileName), false),
+        compression(_compression),
+        chunks(chunkCount < 2 ? 2 : chunkCount) {
+    for (auto &chunk : chunks) {
+        chunk.data.resize(chunkSize);
+        freeChunks.push_back(&chunk);
+    }
+#ifndef ORDER_MATCHING_ENGINE_HAVE_ZSTD
+    if (compression == Compression::ZSTD) {
+        std::cerr << "The input file: " << fileName << " is zstd compressed, but zstd support is not built in! " << std::endl;
+        return;
+    }
+#endif
+    std::ifstream probe(fileName);
+    if (!probe.is_open()) {
+        std::cerr << "The input file: " << fileName << " cannot be open! " << std::endl;
+        return;
+    }
+    std::cout << "Opened " << fileName << " to read compressed ITCH 5.0. messages." << std::endl;
+    validFile = true;
+    decompressor = std::thread(&CompressedReader::decompress, this);
+    start = time(0);
+}
+
+CompressedReader::~CompressedReader(){
+    {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        stopping = true;
+    }
+    chunkSignal.notify_all();
+    if (decompressor.joinable()) {
+        decompressor.join();
+        std::cout << "File " << fileName << " has been closed" << std::endl;
+        std::cout << "Finished, processed " << count << " messages in " << difftime(time(0),start) << "seconds."  << std::endl;
+    }
+}
+
+// read-ahead thread
+
+void CompressedReader::fail(const std::string &reason){
+    std::cerr << "Decompression of " << fileName << " failed: " << reason << std::endl;
+    decompressionFailed = true;
+}
+
+CompressedReader::Chunk *CompressedReader::acquireFree(){
+    std::unique_lock<std::mutex> lock(chunkMutex);
+    chunkSignal.wait(lock, [this]{ return stopping || !freeChunks.empty(); });
+    if (stopping) {
+        return nullptr;
+    }
+    Chunk *chunk = freeChunks.front();
+    freeChunks.pop_front();
+    return chunk;
+}
+
+bool CompressedReader::publish(Chunk *chunk){
+    {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        filledChunks.push_back(chunk);
+    }
+    chunkSignal.notify_all();
+    return true;
+}
+
+void CompressedReader::decompress(){
+    if (compression == Compression::GZIP) {
+        decompressGzip();
+    } else {
+        decompressZstd();
+    }
+    {
+        std::lock_guard<std::mutex> lock(chunkMutex);
+        producerDone = true;
+    }
+    chunkSignal.notify_all();
+}
+
+void CompressedReader::decompressGzip(){
+    gzFile gz = gzopen(fileName.c_str(), "rb");
+    if (gz == nullptr) {
+        fail("cannot open the file");
+        return;
+    }
+    gzbuffer(gz, 1 << 20);
+    while (Chunk *chunk = acquireFree()) {
+        int n = gzread(gz, chunk->data.data(), static_cast<unsigned>(chunk->data.size()));
+        if (n <= 0) {
+            // a truncated file reads as 0 bytes with Z_BUF_ERROR set
+            int error = Z_OK;
+            const char *reason = gzerror(gz, &error);
+            if (n < 0 || error == Z_BUF_ERROR) {
+                fail(reason);
+            }
+            std::lock_guard<std::mutex> lock(chunkMutex);
+            freeChunks.push_back(chunk);
+            break;
+        }
+        chunk->size = static_cast<size_t>(n);
+        publish(chunk);
+    }
+    gzclose(gz);
+}
+
+void CompressedReader::decompressZstd(){
+#ifdef ORDER_MATCHING_ENGINE_HAVE_ZSTD
+    FILE *file = fopen(fileName.c_str(), "rb");
+    if (file == nullptr) {
+        fail("cannot open the file");
+        return;
+    }
+    ZSTD_DStream *stream = ZSTD_createDStream();
+    ZSTD_initDStream(stream);
+    std::vector<char> input(ZSTD_DStreamInSize());
+    ZSTD_inBuffer in = {input.data(), 0, 0};
+    bool inputDone = false;
+    // 0 once the last frame is complete
+    size_t status = 0;
+    while (!inputDone) {
+        Chunk *chunk = acquireFree();
+        if (chunk == nullptr) {
+            break;
+        }
+        ZSTD_outBuffer out = {chunk->data.data(), chunk->data.size(), 0};
+        while (out.pos < out.size) {
+            if (in.pos == in.size) {
+                in.size = fread(input.data(), 1, input.size(), file);
+                in.pos = 0;
+                if (in.size == 0) {
+                    if (ferror(file)) {
+                        fail("read error");
+                    } else if (status != 0) {
+                        fail("unexpected end of file");
+                    }
+                    inputDone = true;
+                    break;
+                }
+            }
+            status = ZSTD_decompressStream(stream, &out, &in);
+            if (ZSTD_isError(status)) {
+                fail(ZSTD_getErrorName(status));
+                inputDone = true;
+                break;
+            }
+        }
+        chunk->size = out.pos;
+        if (chunk->size > 0) {
+            publish(chunk);
+        } else {
+            std::lock_guard<std::mutex> lock(chunkMutex);
+            freeChunks.push_back(chunk);
+        }
+    }
+    ZSTD_freeDStream(stream);
+    fclose(file);
+#endif
+}
+
+// consumer side
+
+bool CompressedReader::nextChunk(){
+    std::unique_lock<std::mutex> lock(chunkMutex);
+    if (current != nullptr) {
+        freeChunks.push_back(current);
+        current = nullptr;
+        chunkSignal.notify_all();
+    }
+    chunkSignal.wait(lock, [this]{ return !filledChunks.empty() || producerDone; });
+    if (filledChunks.empty()) {
+        return false;
+    }
+    current = filledChunks.front();
+    filledChunks.pop_front();
+    position = 0;
+    return true;
+}
+
+bool CompressedReader::eof(){
+    while (current == nullptr || position >= current->size) {
+        if (!validFile || !nextChunk()) {
+            if (decompressionFailed) {
+                validFile = false;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CompressedReader::seek(uint64_t offset, unsigned messageCount){
+    if (!validFile || offset < frameOffset) {
+        return false;
+    }
+    uint64_t left = offset - frameOffset;
+    while (left > 0 && !eof()) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(left, current->size - position));
+        position += n;
+        left -= n;
+    }
+    if (left > 0) {
+        return false;
+    }
+    frameOffset = offset;
+    count = messageCount;
+    return true;
+}
+
+void CompressedReader::readBytesIntoMessage(const long &size){
+    size_t wanted = static_cast<size_t>(size);
+    if (!eof() && current->size - position >= wanted) {
+        message = current->data.data() + position;
+        position += wanted;
+        return;
+    }
+    // frame straddles two chunks
+    size_t copied = 0;
+    while (copied < wanted && copied < sizeof(carry) && !eof()) {
+        size_t n = std::min(wanted - copied, current->size - position);
+        n = std::min(n, sizeof(carry) - copied);
+        std::memcpy(carry + copied, current->data.data() + position, n);
+        position += n;
+        copied += n;
+    }
+    if (copied < wanted) {
+        // truncated last frame: behave like a failed stream read
+        validFile = false;
+    }
+    message = carry;
+}
+
+void CompressedReader::skipBytes(const long &size){
+    long left = size;
+    while (left > 0 && !eof()) {
+        size_t n = std::min(static_cast<size_t>(left), current->size - position);
+        position += n;
+        left -= static_cast<long>(n);
+    }
+}
+
+char CompressedReader::getKey(){
+    return eof() ? 0 : current->data[position++];
+}
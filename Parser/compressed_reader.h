@@ -0,0 +1,83 @@
+#ifndef ORDER_MATCHING_ENGINE_COMPRESSED_READER_H
+#define ORDER_MATCHING_ENGINE_COMPRESSED_READER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "reader.h"
+
+enum class Compression : unsigned char {
+    NONE,
+    GZIP,
+    ZSTD
+};
+
+/**
+ * Detects the compression of a file from its magic bytes.
+ */
+Compression detectCompression(const std::string &fileName);
+
+/**
+ * ITCH 5.0 reader over a gzip or zstd compressed file.
+ *
+ * A read-ahead thread decompresses into a small ring of large chunks
+ * (triple buffering by default) while the caller consumes the previous
+ * ones. Frames are handed out in place from the chunk; only a frame that
+ * straddles two chunks is assembled in a small carry buffer. Drop-in
+ * replacement for Reader.
+ */
+class CompressedReader : public Reader{
+private:
+    struct Chunk{
+        std::vector<char> data;
+        size_t size = 0;
+    };
+
+    Compression compression;
+    std::vector<Chunk> chunks;
+    std::deque<Chunk*> freeChunks;
+    std::deque<Chunk*> filledChunks;
+    std::mutex chunkMutex;
+    std::condition_variable chunkSignal;
+    bool producerDone = false;
+    bool stopping = false;
+    // set by the read-ahead thread on a corrupt or truncated file; the
+    // consumer turns it into !isValid() once the last chunk is consumed
+    std::atomic<bool> decompressionFailed{false};
+    std::thread decompressor;
+
+    Chunk *current = nullptr;
+    size_t position = 0;
+    char carry[64];
+
+    void decompress();
+    void decompressGzip();
+    void decompressZstd();
+    void fail(const std::string &reason);
+    Chunk *acquireFree();
+    bool publish(Chunk *);
+    bool nextChunk();
+
+public:
+    /**
+     * @param[in] fileName compressed ITCH 5.0 file.
+     * @param[in] compression format of the file, see detectCompression().
+     * @param[in] chunkSize bytes decompressed per chunk.
+     * @param[in] chunkCount chunks in flight (2 = double buffering).
+     */
+    CompressedReader(std::string fileName, Compression compression,
+                     size_t chunkSize = 8 << 20, size_t chunkCount = 3);
+    ~CompressedReader() override;
+
+    bool eof() override;
+    // forward only: skips decompressed bytes up to 'offset'
+    bool seek(uint64_t offset, unsigned messageCount) override;
+    void readBytesIntoMessage(const long &) override;
+    void skipBytes(const long &) override;
+    char getKey() override;
+};
+
+#endif //ORDER_MATCHING_ENGINE_COMPRESSED_READER_H
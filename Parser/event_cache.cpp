@@ -0,0 +1,186 @@
+#include "event_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "reader_factory.h"
+
+constexpr char EventCacheHeader::MAGIC[8];
+
+namespace {
+
+// multiply-xorshift over 8-byte words; the tail is zero padded
+uint64_t mixWords(const char *bytes, size_t size){
+    const uint64_t prime = 0x9E3779B97F4A7C15ULL;
+    uint64_t hash = size * prime;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + i, size - i);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+}
+
+bool fileChecksum(const std::string &fileName, uint64_t &checksum, uint64_t &size){
+    int fd = open(fileName.c_str(), O_RDONLY);
+    struct stat st{};
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    size = static_cast<uint64_t>(st.st_size);
+    checksum = 0;
+    bool ok = true;
+    if (size > 0) {
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ok = false;
+        } else {
+            madvise(mapped, size, MADV_SEQUENTIAL);
+            checksum = mixWords(static_cast<const char *>(mapped), size);
+            munmap(mapped, size);
+        }
+    } else {
+        checksum = mixWords(nullptr, 0);
+    }
+    close(fd);
+    return ok;
+}
+
+long buildEventCache(const std::string &sourceFileName, const std::string &cacheFileName){
+    EventCacheHeader header{};
+    std::memcpy(header.magic, EventCacheHeader::MAGIC, sizeof(header.magic));
+    header.version = EventCacheHeader::VERSION;
+    header.recordSize = sizeof(BookEvent);
+    header.byteOrder = EventCacheHeader::BYTE_ORDER_MARK;
+    if (!fileChecksum(sourceFileName, header.sourceChecksum, header.sourceSize)) {
+        std::cerr << "The input file: " << sourceFileName << " cannot be open! " << std::endl;
+        return -1;
+    }
+
+    std::unique_ptr<Reader> reader = openReader(sourceFileName);
+    if (!reader->isValid()) {
+        return -1;
+    }
+    FILE *out = std::fopen(cacheFileName.c_str(), "wb");
+    if (out == nullptr) {
+        std::cerr << "The cache file: " << cacheFileName << " cannot be created! " << std::endl;
+        return -1;
+    }
+
+    // header goes last, once recordCount is known; an interrupted build
+    // leaves a zero magic behind and is rejected
+    EventCacheHeader placeholder{};
+    bool ok = std::fwrite(&placeholder, sizeof(placeholder), 1, out) == 1;
+
+    std::vector<BookEvent> batch;
+    batch.reserve(4096);
+    while (ok && !reader->eof() && reader->isValid()) {
+        uint16_t length;
+        const char *frame = reader->nextFrame(length);
+        BookEvent event;
+        if (frame == nullptr || !decodeBookEvent(frame, length, event)) {
+            continue;
+        }
+        batch.push_back(event);
+        if (batch.size() == batch.capacity()) {
+            ok = std::fwrite(batch.data(), sizeof(BookEvent), batch.size(), out) == batch.size();
+            header.recordCount += batch.size();
+            batch.clear();
+        }
+    }
+    if (!reader->isValid()) {
+        // a partial day must not pass for the whole one
+        std::cerr << "The input file: " << sourceFileName << " is corrupt or truncated, no cache written! " << std::endl;
+        std::fclose(out);
+        std::remove(cacheFileName.c_str());
+        return -1;
+    }
+    if (ok && !batch.empty()) {
+        ok = std::fwrite(batch.data(), sizeof(BookEvent), batch.size(), out) == batch.size();
+        header.recordCount += batch.size();
+    }
+    ok = ok && std::fseek(out, 0, SEEK_SET) == 0
+            && std::fwrite(&header, sizeof(header), 1, out) == 1;
+    ok = (std::fclose(out) == 0) && ok;
+    if (!ok) {
+        std::cerr << "The cache file: " << cacheFileName << " cannot be written! " << std::endl;
+        std::remove(cacheFileName.c_str());
+        return -1;
+    }
+    std::cout << "Cached " << header.recordCount << " book events of " << sourceFileName
+              << " in " << cacheFileName << std::endl;
+    return static_cast<long>(header.recordCount);
+}
+
+EventCache::EventCache(const std::string &cacheFileName, const std::string &sourceFileName){
+    fd = open(cacheFileName.c_str(), O_RDONLY);
+    struct stat st{};
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "The cache file: " << cacheFileName << " cannot be open! " << std::endl;
+        return;
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length < sizeof(EventCacheHeader)) {
+        std::cerr << "The cache file: " << cacheFileName << " is truncated! " << std::endl;
+        return;
+    }
+    void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "The cache file: " << cacheFileName << " cannot be mapped! " << std::endl;
+        return;
+    }
+    madvise(mapped, length, MADV_SEQUENTIAL);
+    madvise(mapped, length, MADV_WILLNEED);
+    data = static_cast<const char *>(mapped);
+
+    EventCacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, EventCacheHeader::MAGIC, sizeof(header.magic)) != 0
+        || header.version != EventCacheHeader::VERSION
+        || header.recordSize != sizeof(BookEvent)
+        || header.byteOrder != EventCacheHeader::BYTE_ORDER_MARK) {
+        std::cerr << "The cache file: " << cacheFileName << " has an unsupported format! " << std::endl;
+        return;
+    }
+    if (header.recordCount != (length - sizeof(header)) / sizeof(BookEvent)) {
+        std::cerr << "The cache file: " << cacheFileName << " is truncated! " << std::endl;
+        return;
+    }
+    if (!sourceFileName.empty()) {
+        uint64_t checksum, size;
+        if (!fileChecksum(sourceFileName, checksum, size)
+            || size != header.sourceSize || checksum != header.sourceChecksum) {
+            std::cerr << "The cache file: " << cacheFileName << " was not built from "
+                      << sourceFileName << "! " << std::endl;
+            return;
+        }
+    }
+    events = reinterpret_cast<const BookEvent *>(data + sizeof(header));
+    eventCount = header.recordCount;
+    valid = true;
+}
+
+EventCache::~EventCache(){
+    if (data != nullptr) {
+        munmap(const_cast<char *>(data), length);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
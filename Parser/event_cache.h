@@ -0,0 +1,89 @@
+#ifndef ORDER_MATCHING_ENGINE_EVENT_CACHE_H
+#define ORDER_MATCHING_ENGINE_EVENT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "book_event.h"
+
+static_assert(std::is_trivially_copyable<BookEvent>::value, "BookEvent is stored as raw bytes");
+static_assert(sizeof(BookEvent) == 48, "BookEvent layout changed, bump EventCacheHeader::VERSION");
+
+/**
+ * Header of a pre-decoded event cache file, followed by recordCount
+ * BookEvent records in native byte order.
+ */
+struct EventCacheHeader{
+    static constexpr char MAGIC[8] = {'O', 'M', 'E', 'E', 'V', 'T', 'C', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t byteOrder;
+    uint32_t reserved0;
+    uint64_t recordCount;
+    uint64_t sourceSize;        // bytes of the ITCH file the cache was built from
+    uint64_t sourceChecksum;    // fileChecksum() of that file
+    uint64_t reserved1[2];
+};
+static_assert(sizeof(EventCacheHeader) == 64, "header is padded to one cache line");
+
+/**
+ * 64-bit checksum of a file's bytes (not a cryptographic hash).
+ *
+ * @param[out] size file size in bytes.
+ * @return false if the file cannot be read.
+ */
+bool fileChecksum(const std::string &fileName, uint64_t &checksum, uint64_t &size);
+
+/**
+ * Converts an ITCH 5.0 file (raw or compressed) into an event cache once:
+ * every book-relevant frame ('R', 'A', 'F', 'E', 'C', 'X', 'D', 'U') is
+ * decoded into a BookEvent and written out as is.
+ *
+ * @return number of events written, or -1 if the source cannot be read or
+ *         the cache cannot be written.
+ */
+long buildEventCache(const std::string &sourceFileName, const std::string &cacheFileName);
+
+/**
+ * Read-only, memory-mapped view of an event cache file.
+ *
+ * Replaying from the cache skips framing, byte swapping and ticker parsing
+ * entirely; events are read straight out of the page cache.
+ */
+class EventCache{
+private:
+    int fd = -1;
+    const char *data = nullptr;
+    size_t length = 0;
+    const BookEvent *events = nullptr;
+    size_t eventCount = 0;
+    bool valid = false;
+
+public:
+    /**
+     * Maps and validates the cache. If sourceFileName is not empty, the
+     * cache must also have been built from that exact file. On any mismatch
+     * the reason is printed to standard error and isValid() returns false.
+     *
+     * @param[in] cacheFileName cache written by buildEventCache().
+     * @param[in] sourceFileName ITCH file the cache should belong to.
+     */
+    EventCache(const std::string &cacheFileName, const std::string &sourceFileName = "");
+    ~EventCache();
+
+    EventCache(const EventCache &) = delete;
+    EventCache &operator=(const EventCache &) = delete;
+
+    bool isValid() const{ return valid; }
+    size_t size() const{ return eventCount; }
+    const BookEvent *begin() const{ return events; }
+    const BookEvent *end() const{ return events + eventCount; }
+};
+
+
+#endif //ORDER_MATCHING_ENGINE_EVENT_CACHE_H
@@ -0,0 +1,65 @@
+#include "feed_merger.h"
+
+#include <algorithm>
+#include "itch_view.h"
+#include "reader_factory.h"
+
+FeedMerger::FeedMerger(const std::vector<std::string> &fileNames, bool memoryMapped){
+    if (fileNames.size() > UINT8_MAX + 1) {
+        std::cerr << "Cannot merge more than " << UINT8_MAX + 1 << " feeds" << std::endl;
+        return;
+    }
+    for (const auto &fileName : fileNames) {
+        readers.push_back(openReader(fileName, memoryMapped));
+    }
+    heap.reserve(readers.size());
+    for (size_t venue = 0; venue < readers.size(); ++venue) {
+        advance(static_cast<uint8_t>(venue));
+    }
+}
+
+bool FeedMerger::isValid() const{
+    return !readers.empty() && std::all_of(readers.begin(), readers.end(),
+                                           [](const std::unique_ptr<Reader> &reader){ return reader->isValid(); });
+}
+
+bool FeedMerger::later(const Head &a, const Head &b){
+    return a.timestamp != b.timestamp ? a.timestamp > b.timestamp : a.venue > b.venue;
+}
+
+void FeedMerger::advance(uint8_t venue){
+    Reader &reader = *readers[venue];
+    uint16_t length;
+    const char *frame = nullptr;
+    while (frame == nullptr && !reader.eof() && reader.isValid()) {
+        frame = reader.nextFrame(length);
+    }
+    if (frame == nullptr) {
+        return;
+    }
+    uint64_t timestamp = length >= itch::View::Timestamp::offset + itch::View::Timestamp::width
+                         ? itch::View::Timestamp::get(frame) : 0;
+    heap.push_back({timestamp, venue, frame, length});
+    std::push_heap(heap.begin(), heap.end(), later);
+}
+
+bool FeedMerger::next(MergedFrame &out){
+    if (pending >= 0) {
+        advance(static_cast<uint8_t>(pending));
+        pending = -1;
+    }
+    if (heap.empty()) {
+        return false;
+    }
+    std::pop_heap(heap.begin(), heap.end(), later);
+    const Head &head = heap.back();
+    out.frame = head.frame;
+    out.length = head.length;
+    out.venue = head.venue;
+    out.timestamp = head.timestamp;
+    // the frame lives in the reader's storage: read on only at the next call
+    pending = head.venue;
+    heap.pop_back();
+    merged++;
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef ORDER_MATCHING_ENGINE_FEED_MERGER_H
+#define ORDER_MATCHING_ENGINE_FEED_MERGER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "reader.h"
+
+/**
+ * Frame of a merged replay, tagged with the feed it came from.
+ */
+struct MergedFrame{
+    const char *frame = nullptr;   // valid until the next FeedMerger::next()
+    uint16_t length = 0;
+    uint8_t venue = 0;             // index of the feed in the input list
+    uint64_t timestamp = 0;
+};
+
+/**
+ * Timestamp-ordered k-way merge of several ITCH 5.0 feeds.
+ *
+ * Each feed keeps exactly one frame of lookahead, held in place in its own
+ * reader's storage, and a small binary heap keyed by (timestamp, venue)
+ * picks the earliest. A feed is only advanced after its lookahead frame
+ * has been handed out, so frames are never copied. Frames of one feed keep
+ * their file order; equal timestamps across feeds go in venue order.
+ */
+class FeedMerger{
+private:
+    struct Head{
+        uint64_t timestamp;
+        uint8_t venue;
+        const char *frame;
+        uint16_t length;
+    };
+
+    std::vector<std::unique_ptr<Reader>> readers;
+    std::vector<Head> heap;
+    int pending = -1;              // feed to advance before the next pop
+    unsigned long merged = 0;
+
+    // heap order: std heap functions keep the greatest element on top
+    static bool later(const Head &a, const Head &b);
+    void advance(uint8_t venue);
+
+public:
+    /**
+     * @param[in] fileNames ITCH 5.0 inputs in venue order (raw, compressed
+     *            or pcap; see openReader()), at most 256.
+     * @param[in] memoryMapped see openReader().
+     */
+    FeedMerger(const std::vector<std::string> &fileNames, bool memoryMapped = true);
+
+    /**
+     * @param[out] out the earliest frame over all feeds.
+     * @return false once every feed is exhausted.
+     */
+    bool next(MergedFrame &out);
+
+    bool isValid() const;
+    size_t feedCount() const{ return readers.size(); }
+    Reader &getReader(uint8_t venue){ return *readers[venue]; }
+    unsigned long getMerged() const{ return merged; }
+};
+
+#endif //ORDER_MATCHING_ENGINE_FEED_MERGER_H
@@ -0,0 +1,99 @@
+#include "frame_filter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "itch_dispatch.h"
+#include "itch_view.h"
+
+FrameFilter::FrameFilter(const std::vector<std::string> &symbols) :
+        acceptAll(symbols.empty()) {
+    for (const auto &symbol : symbols) {
+        char bytes[8] = {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '};
+        std::memcpy(bytes, symbol.data(), std::min<size_t>(symbol.size(), 8));
+        symbolKeys.push_back(itch::Ticker{bytes}.key());
+    }
+    std::sort(symbolKeys.begin(), symbolKeys.end());
+}
+
+std::vector<std::string> FrameFilter::loadSymbols(const std::string &fileName){
+    std::vector<std::string> symbols;
+    std::ifstream file(fileName);
+    if (!file.is_open()) {
+        std::cerr << "The symbol file: " << fileName << " cannot be open! " << std::endl;
+        return symbols;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
+        if (!line.empty() && line[0] != '#') {
+            symbols.push_back(line);
+        }
+    }
+    return symbols;
+}
+
+std::vector<std::string> FrameFilter::parseSymbols(const std::string &list){
+    std::vector<std::string> symbols;
+    std::stringstream stream(list);
+    std::string symbol;
+    while (std::getline(stream, symbol, ',')) {
+        if (!symbol.empty()) {
+            symbols.push_back(symbol);
+        }
+    }
+    return symbols;
+}
+
+uint8_t FrameFilter::resolve(uint16_t locate, const char *ticker){
+    bool found = std::binary_search(symbolKeys.begin(), symbolKeys.end(), itch::Ticker{ticker}.key());
+    locateState[locate] = found ? WATCHED : IGNORED;
+    return locateState[locate];
+}
+
+bool FrameFilter::accept(char type, uint16_t locate, const char *ticker){
+    uint8_t state = locateState[locate];
+    bool keep;
+    if (type == itch::StockDirectoryView::type_code) {
+        keep = resolve(locate, ticker) == WATCHED;
+    } else if (locate == 0) {
+        // market wide messages (system events, MWCB, ...)
+        keep = true;
+    } else if (state == UNKNOWN && (type == itch::AddOrderView::type_code || type == itch::AddOrderMpidView::type_code)) {
+        keep = resolve(locate, ticker) == WATCHED;
+    } else {
+        keep = state == WATCHED;
+    }
+    keep ? accepted++ : dropped++;
+    return keep;
+}
+
+bool FrameFilter::accept(const char *frame, uint16_t length){
+    char type = frame[0];
+    // the locate of any message, and all of a known one, must be there
+    // before a single field is read
+    uint16_t least = std::max<uint16_t>(itch::message_lengths[static_cast<unsigned char>(type)],
+                                        itch::View::StockLocate::offset + itch::View::StockLocate::width);
+    if (length < least) {
+        dropped++;
+        return false;
+    }
+    if (acceptAll) {
+        accepted++;
+        return true;
+    }
+    // only read for 'R', 'A' and 'F'
+    unsigned tickerOffset = type == itch::StockDirectoryView::type_code ?
+            itch::StockDirectoryView::StockField::offset : itch::AddOrderView::StockField::offset;
+    return accept(type, itch::View::StockLocate::get(frame), frame + tickerOffset);
+}
+
+bool FrameFilter::accept(const BookEvent &event){
+    if (acceptAll) {
+        accepted++;
+        return true;
+    }
+    return accept(event.type, event.stockLocate, reinterpret_cast<const char *>(&event.stock));
+}
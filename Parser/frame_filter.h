@@ -0,0 +1,77 @@
+#ifndef ORDER_MATCHING_ENGINE_FRAME_FILTER_H
+#define ORDER_MATCHING_ENGINE_FRAME_FILTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "book_event.h"
+
+/**
+ * Pre-decode symbol filter over raw ITCH 5.0 frames.
+ *
+ * Every ITCH message carries the stock locate code of its instrument at
+ * offset 1, so once a locate is known to be watched or not, any frame can
+ * be accepted or dropped with a single byte load, before it is decoded or
+ * its order reference is hashed anywhere. Delete, cancel, execute and
+ * replace frames of unwatched symbols are dropped this way without having
+ * to track order references.
+ *
+ * Locates are resolved from the 'R' stock directory, or from the ticker of
+ * the first Add/Add-MPID of that locate when the file has no directory;
+ * tickers are compared as one packed 8-byte integer.
+ */
+class FrameFilter{
+private:
+    enum : uint8_t { UNKNOWN = 0, WATCHED = 1, IGNORED = 2 };
+
+    // packed 8-byte tickers, sorted
+    std::vector<uint64_t> symbolKeys;
+    std::vector<uint8_t> locateState = std::vector<uint8_t>(UINT16_MAX + 1, UNKNOWN);
+    bool acceptAll;
+    unsigned long accepted = 0;
+    unsigned long dropped = 0;
+
+    uint8_t resolve(uint16_t locate, const char *ticker);
+    bool accept(char type, uint16_t locate, const char *ticker);
+
+public:
+    /**
+     * @param[in] symbols symbols to keep; an empty list keeps everything.
+     */
+    FrameFilter(const std::vector<std::string> &symbols);
+
+    /**
+     * Reads a symbol list, one symbol per line (blank lines and lines
+     * starting with '#' are ignored).
+     */
+    static std::vector<std::string> loadSymbols(const std::string &fileName);
+
+    /**
+     * Splits a comma separated symbol list, e.g. "AAPL,MSFT".
+     */
+    static std::vector<std::string> parseSymbols(const std::string &list);
+
+    /**
+     * @param[in] frame ITCH frame, starting at the message type.
+     * @param[in] length length of the frame.
+     * @return false if the frame belongs to an unwatched symbol, or is
+     *         shorter than its message type.
+     */
+    bool accept(const char *frame, uint16_t length);
+
+    /**
+     * Same as above for an already decoded event (e.g. from an EventCache).
+     */
+    bool accept(const BookEvent &event);
+
+    // true if stock locate 'locate' is known to be watched
+    bool watched(uint16_t locate) const{
+        return acceptAll || locateState[locate] == WATCHED;
+    }
+
+    unsigned long getAccepted() const{ return accepted; }
+    unsigned long getDropped() const{ return dropped; }
+};
+
+
+#endif //ORDER_MATCHING_ENGINE_FRAME_FILTER_H
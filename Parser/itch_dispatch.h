@@ -0,0 +1,103 @@
+#ifndef ORDER_MATCHING_ENGINE_ITCH_DISPATCH_H
+#define ORDER_MATCHING_ENGINE_ITCH_DISPATCH_H
+
+#include <array>
+#include <type_traits>
+#include <utility>
+#include "itch_view.h"
+
+/**
+ * Compile-time generated dispatch over the ITCH 5.0 schema of itch_view.h.
+ *
+ * A handler is any type with on(const XxxView&) overloads for the messages
+ * it cares about. For each handler a 256-entry table indexed by the type
+ * byte is built at compile time; entries for messages the handler does not
+ * take are empty, so those frames are skipped by the caller's cursor using
+ * the frame's own length prefix and never decoded.
+ */
+namespace itch {
+
+template<typename... Ms>
+struct MessageList {};
+
+using Itch50 = MessageList<
+        SystemEventView, StockDirectoryView, StockTradingActionView,
+        RegShoRestrictionView, MarketParticipantPositionView,
+        MwcbDeclineLevelView, MwcbStatusView, IpoQuotingPeriodView,
+        LuldAuctionCollarView, OperationalHaltView,
+        AddOrderView, AddOrderMpidView,
+        OrderExecutedView, OrderExecutedWithPriceView, OrderCancelView,
+        OrderDeleteView, OrderReplaceView,
+        TradeView, CrossTradeView, BrokenTradeView,
+        NoiiView, RpiiView, DirectListingCapitalRaiseView>;
+
+// true if Handler has an on() overload accepting message view M
+template<typename Handler, typename M, typename = void>
+struct Handles : std::false_type {};
+
+template<typename Handler, typename M>
+struct Handles<Handler, M, std::void_t<decltype(std::declval<Handler&>().on(std::declval<const M&>()))>>
+        : std::true_type {};
+
+template<typename... Ms>
+constexpr std::array<uint16_t, 256> make_length_table(MessageList<Ms...>){
+    std::array<uint16_t, 256> table{};
+    ((table[static_cast<unsigned char>(Ms::type_code)] = Ms::length), ...);
+    return table;
+}
+
+// schema length of every message type, 0 for types not in ITCH 5.0
+inline constexpr std::array<uint16_t, 256> message_lengths = make_length_table(Itch50{});
+
+template<typename Handler>
+struct DispatchEntry{
+    void (*handle)(Handler&, const char*) = nullptr;
+    uint16_t length = 0;
+};
+
+template<typename Handler, typename M>
+void invoke(Handler &handler, const char *frame){
+    handler.on(M(frame));
+}
+
+template<typename Handler, typename M>
+constexpr DispatchEntry<Handler> make_entry(){
+    if constexpr (Handles<Handler, M>::value) {
+        return {&invoke<Handler, M>, M::length};
+    } else {
+        return {nullptr, M::length};
+    }
+}
+
+template<typename Handler, typename... Ms>
+constexpr std::array<DispatchEntry<Handler>, 256> make_dispatch_table(MessageList<Ms...>){
+    std::array<DispatchEntry<Handler>, 256> table{};
+    ((table[static_cast<unsigned char>(Ms::type_code)] = make_entry<Handler, Ms>()), ...);
+    return table;
+}
+
+template<typename Handler>
+inline constexpr std::array<DispatchEntry<Handler>, 256> dispatch_table =
+        make_dispatch_table<Handler>(Itch50{});
+
+/**
+ * Hands one frame to the matching on() overload of 'handler'.
+ *
+ * @param[in] frame ITCH frame, starting at the message type.
+ * @param[in] length frame length from its 2-byte prefix.
+ * @return true if the handler took the frame, false if the type is not
+ *         handled, unknown, or the frame is shorter than its schema length.
+ */
+template<typename Handler>
+inline bool dispatch(Handler &handler, const char *frame, uint16_t length){
+    const auto &entry = dispatch_table<Handler>[static_cast<unsigned char>(frame[0])];
+    if (entry.handle == nullptr || length < entry.length) {
+        return false;
+    }
+    entry.handle(handler, frame);
+    return true;
+}
+
+} // namespace itch
+
+#endif //ORDER_MATCHING_ENGINE_ITCH_DISPATCH_H
@@ -0,0 +1,353 @@
+#ifndef ORDER_MATCHING_ENGINE_ITCH_VIEW_H
+#define ORDER_MATCHING_ENGINE_ITCH_VIEW_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * The ITCH 5.0 schema and zero-copy views over raw frames.
+ *
+ * Every message kind is described once, as a view type carrying its type
+ * byte, its length and its fields (offset/width). The field decoders, the
+ * per-type views and the dispatch table in itch_dispatch.h are all derived
+ * from these descriptions.
+ *
+ * A view wraps a pointer to the first byte (the message type) of a frame
+ * that lives in the reader's storage and decodes big-endian fields only
+ * when they are asked for. Views never allocate and are only valid until
+ * the reader moves to the next frame.
+ *
+ * Offsets follow the Nasdaq TotalView-ITCH 5.0 specification.
+ */
+namespace itch {
+
+inline uint16_t load_be16(const char *p){
+    uint16_t v; std::memcpy(&v, p, 2); return __builtin_bswap16(v);
+}
+
+inline uint32_t load_be32(const char *p){
+    uint32_t v; std::memcpy(&v, p, 4); return __builtin_bswap32(v);
+}
+
+inline uint64_t load_be64(const char *p){
+    uint64_t v; std::memcpy(&v, p, 8); return __builtin_bswap64(v);
+}
+
+// 6-byte nanoseconds since midnight
+inline uint64_t load_be48(const char *p){
+    return (static_cast<uint64_t>(load_be16(p)) << 32) | load_be32(p + 2);
+}
+
+/**
+ * Fixed 8-byte, space padded stock symbol as it appears on the wire.
+ * key() packs the bytes into one integer so symbols compare in one
+ * instruction; it matches make_symbol_key() of the order matcher.
+ */
+struct Ticker{
+    const char *bytes;
+
+    uint64_t key() const{ uint64_t k; std::memcpy(&k, bytes, 8); return k; }
+    std::string_view str() const{
+        size_t n = 8;
+        while (n > 0 && bytes[n - 1] == ' ') --n;
+        return {bytes, n};
+    }
+};
+
+/**
+ * Big-endian integer (or single character) field at a fixed offset.
+ */
+template<unsigned Offset, unsigned Width>
+struct Field{
+    static constexpr unsigned offset = Offset;
+    static constexpr unsigned width = Width;
+    static_assert(Width == 1 || Width == 2 || Width == 4 || Width == 6 || Width == 8,
+                  "unsupported ITCH integer width");
+
+    static auto get(const char *p){
+        if constexpr (Width == 1) return p[Offset];
+        else if constexpr (Width == 2) return load_be16(p + Offset);
+        else if constexpr (Width == 4) return load_be32(p + Offset);
+        else if constexpr (Width == 6) return load_be48(p + Offset);
+        else return load_be64(p + Offset);
+    }
+};
+
+/**
+ * Space padded alphanumeric field at a fixed offset.
+ */
+template<unsigned Offset, unsigned Width>
+struct Alpha{
+    static constexpr unsigned offset = Offset;
+    static constexpr unsigned width = Width;
+
+    static std::string_view get(const char *p){ return {p + Offset, Width}; }
+};
+
+// stock symbols are the only 8-byte alpha fields and get their own type
+template<unsigned Offset>
+struct Stock{
+    static constexpr unsigned offset = Offset;
+    static constexpr unsigned width = 8;
+
+    static Ticker get(const char *p){ return {p + Offset}; }
+};
+
+/**
+ * Common header of every message: type, stock locate, tracking number and
+ * timestamp.
+ */
+class View{
+protected:
+    const char *p;
+public:
+    using Type = Field<0, 1>;
+    using StockLocate = Field<1, 2>;
+    using TrackingNumber = Field<3, 2>;
+    using Timestamp = Field<5, 6>;
+
+    explicit View(const char *frame) : p(frame) {}
+    const char *data() const{ return p; }
+    char type() const{ return Type::get(p); }
+    uint16_t stockLocate() const{ return StockLocate::get(p); }
+    uint16_t trackingNumber() const{ return TrackingNumber::get(p); }
+    uint64_t timestamp() const{ return Timestamp::get(p); }
+};
+
+// 'S'
+struct SystemEventView : View{
+    static constexpr char type_code = 'S';
+    static constexpr uint16_t length = 12;
+    using EventCode = Field<11, 1>;
+
+    using View::View;
+    char eventCode() const{ return EventCode::get(p); }
+};
+
+// 'R'
+struct StockDirectoryView : View{
+    static constexpr char type_code = 'R';
+    static constexpr uint16_t length = 39;
+    using StockField = Stock<11>;
+    using MarketCategory = Field<19, 1>;
+    using RoundLotSize = Field<21, 4>;
+
+    using View::View;
+    Ticker stock() const{ return StockField::get(p); }
+    char marketCategory() const{ return MarketCategory::get(p); }
+    uint32_t roundLotSize() const{ return RoundLotSize::get(p); }
+};
+
+// 'H'
+struct StockTradingActionView : View{
+    static constexpr char type_code = 'H';
+    static constexpr uint16_t length = 25;
+    using StockField = Stock<11>;
+    using TradingState = Field<19, 1>;
+
+    using View::View;
+    Ticker stock() const{ return StockField::get(p); }
+    char tradingState() const{ return TradingState::get(p); }
+};
+
+// 'Y'
+struct RegShoRestrictionView : View{
+    static constexpr char type_code = 'Y';
+    static constexpr uint16_t length = 20;
+    using View::View;
+};
+
+// 'L'
+struct MarketParticipantPositionView : View{
+    static constexpr char type_code = 'L';
+    static constexpr uint16_t length = 26;
+    using View::View;
+};
+
+// 'V'
+struct MwcbDeclineLevelView : View{
+    static constexpr char type_code = 'V';
+    static constexpr uint16_t length = 35;
+    using View::View;
+};
+
+// 'W'
+struct MwcbStatusView : View{
+    static constexpr char type_code = 'W';
+    static constexpr uint16_t length = 12;
+    using View::View;
+};
+
+// 'K'
+struct IpoQuotingPeriodView : View{
+    static constexpr char type_code = 'K';
+    static constexpr uint16_t length = 28;
+    using View::View;
+};
+
+// 'J'
+struct LuldAuctionCollarView : View{
+    static constexpr char type_code = 'J';
+    static constexpr uint16_t length = 35;
+    using View::View;
+};
+
+// 'h'
+struct OperationalHaltView : View{
+    static constexpr char type_code = 'h';
+    static constexpr uint16_t length = 21;
+    using View::View;
+};
+
+// 'A'
+struct AddOrderView : View{
+    static constexpr char type_code = 'A';
+    static constexpr uint16_t length = 36;
+    using OrderRef = Field<11, 8>;
+    using Side = Field<19, 1>;
+    using Shares = Field<20, 4>;
+    using StockField = Stock<24>;
+    using Price = Field<32, 4>;
+
+    using View::View;
+    uint64_t orderRef() const{ return OrderRef::get(p); }
+    char side() const{ return Side::get(p); }
+    bool isBuy() const{ return Side::get(p) == 'B'; }
+    uint32_t shares() const{ return Shares::get(p); }
+    Ticker stock() const{ return StockField::get(p); }
+    uint32_t price() const{ return Price::get(p); }
+};
+
+// 'F'
+struct AddOrderMpidView : AddOrderView{
+    static constexpr char type_code = 'F';
+    static constexpr uint16_t length = 40;
+    using Attribution = Alpha<36, 4>;
+
+    using AddOrderView::AddOrderView;
+    std::string_view attribution() const{ return Attribution::get(p); }
+};
+
+// 'E'
+struct OrderExecutedView : View{
+    static constexpr char type_code = 'E';
+    static constexpr uint16_t length = 31;
+    using OrderRef = Field<11, 8>;
+    using ExecutedShares = Field<19, 4>;
+    using MatchNumber = Field<23, 8>;
+
+    using View::View;
+    uint64_t orderRef() const{ return OrderRef::get(p); }
+    uint32_t executedShares() const{ return ExecutedShares::get(p); }
+    uint64_t matchNumber() const{ return MatchNumber::get(p); }
+};
+
+// 'C'
+struct OrderExecutedWithPriceView : OrderExecutedView{
+    static constexpr char type_code = 'C';
+    static constexpr uint16_t length = 36;
+    using Printable = Field<31, 1>;
+    using ExecutionPrice = Field<32, 4>;
+
+    using OrderExecutedView::OrderExecutedView;
+    bool printable() const{ return Printable::get(p) == 'Y'; }
+    uint32_t executionPrice() const{ return ExecutionPrice::get(p); }
+};
+
+// 'X'
+struct OrderCancelView : View{
+    static constexpr char type_code = 'X';
+    static constexpr uint16_t length = 23;
+    using OrderRef = Field<11, 8>;
+    using CancelledShares = Field<19, 4>;
+
+    using View::View;
+    uint64_t orderRef() const{ return OrderRef::get(p); }
+    uint32_t cancelledShares() const{ return CancelledShares::get(p); }
+};
+
+// 'D'
+struct OrderDeleteView : View{
+    static constexpr char type_code = 'D';
+    static constexpr uint16_t length = 19;
+    using OrderRef = Field<11, 8>;
+
+    using View::View;
+    uint64_t orderRef() const{ return OrderRef::get(p); }
+};
+
+// 'U'
+struct OrderReplaceView : View{
+    static constexpr char type_code = 'U';
+    static constexpr uint16_t length = 35;
+    using OriginalOrderRef = Field<11, 8>;
+    using NewOrderRef = Field<19, 8>;
+    using Shares = Field<27, 4>;
+    using Price = Field<31, 4>;
+
+    using View::View;
+    uint64_t originalOrderRef() const{ return OriginalOrderRef::get(p); }
+    uint64_t newOrderRef() const{ return NewOrderRef::get(p); }
+    uint32_t shares() const{ return Shares::get(p); }
+    uint32_t price() const{ return Price::get(p); }
+};
+
+// 'P'
+struct TradeView : View{
+    static constexpr char type_code = 'P';
+    static constexpr uint16_t length = 44;
+    using OrderRef = Field<11, 8>;
+    using Side = Field<19, 1>;
+    using Shares = Field<20, 4>;
+    using StockField = Stock<24>;
+    using Price = Field<32, 4>;
+    using MatchNumber = Field<36, 8>;
+
+    using View::View;
+    uint64_t orderRef() const{ return OrderRef::get(p); }
+    char side() const{ return Side::get(p); }
+    uint32_t shares() const{ return Shares::get(p); }
+    Ticker stock() const{ return StockField::get(p); }
+    uint32_t price() const{ return Price::get(p); }
+    uint64_t matchNumber() const{ return MatchNumber::get(p); }
+};
+
+// 'Q'
+struct CrossTradeView : View{
+    static constexpr char type_code = 'Q';
+    static constexpr uint16_t length = 40;
+    using View::View;
+};
+
+// 'B'
+struct BrokenTradeView : View{
+    static constexpr char type_code = 'B';
+    static constexpr uint16_t length = 19;
+    using View::View;
+};
+
+// 'I'
+struct NoiiView : View{
+    static constexpr char type_code = 'I';
+    static constexpr uint16_t length = 50;
+    using View::View;
+};
+
+// 'N'
+struct RpiiView : View{
+    static constexpr char type_code = 'N';
+    static constexpr uint16_t length = 20;
+    using View::View;
+};
+
+// 'O'
+struct DirectListingCapitalRaiseView : View{
+    static constexpr char type_code = 'O';
+    static constexpr uint16_t length = 48;
+    using View::View;
+};
+
+} // namespace itch
+
+#endif //ORDER_MATCHING_ENGINE_ITCH_VIEW_H
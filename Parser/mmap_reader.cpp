@@ -0,0 +1,80 @@
+#include "mmap_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MmapReader::MmapReader(std::string _fileName) :
+        Reader(std::move(_fileName), false) {
+    fd = open(fileName.c_str(), O_RDONLY);
+    struct stat st{};
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "The input file: " << fileName << " cannot be open! " << std::endl;
+        return;
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length > 0) {
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "The input file: " << fileName << " cannot be mapped! " << std::endl;
+            return;
+        }
+        // hints only, failures are harmless
+        madvise(mapped, length, MADV_SEQUENTIAL);
+        madvise(mapped, length, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+        madvise(mapped, length, MADV_HUGEPAGE);
+#endif
+        data = static_cast<const char *>(mapped);
+    }
+    cursor = data;
+    end = data + length;
+    std::cout << "Mapped " << fileName << " (" << length << " bytes) to read ITCH 5.0. messages." << std::endl;
+    validFile = true;
+    start = time(0);
+}
+
+bool MmapReader::eof(){
+    return cursor >= end;
+}
+
+bool MmapReader::seek(uint64_t offset, unsigned messageCount){
+    if (!validFile || offset > length) {
+        return false;
+    }
+    cursor = data + offset;
+    frameOffset = offset;
+    count = messageCount;
+    return true;
+}
+
+void MmapReader::readBytesIntoMessage(const long &size){
+    if (end - cursor < size) {
+        // truncated last frame: behave like a failed stream read
+        cursor = end;
+        validFile = false;
+        return;
+    }
+    message = cursor;
+    cursor += size;
+}
+
+void MmapReader::skipBytes(const long &size){
+    cursor = (end - cursor < size) ? end : cursor + size;
+}
+
+char MmapReader::getKey(){
+    return (cursor < end) ? *cursor++ : 0;
+}
+
+MmapReader::~MmapReader(){
+    if (data != nullptr) {
+        munmap(const_cast<char *>(data), length);
+    }
+    if (fd >= 0) {
+        close(fd);
+        std::cout << "File " << fileName << " has been closed" << std::endl;
+        std::cout << "Finished, processed " << count << " messages in " << difftime(time(0),start) << "seconds."  << std::endl;
+    }
+}
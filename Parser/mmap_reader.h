@@ -0,0 +1,44 @@
+#ifndef ORDER_MATCHING_ENGINE_MMAP_READER_H
+#define ORDER_MATCHING_ENGINE_MMAP_READER_H
+
+#include <cstddef>
+#include "reader.h"
+
+/**
+ * Memory-mapped ITCH 5.0 reader.
+ *
+ * Maps the whole input file read-only and walks the length-prefixed frames
+ * in place: the byte hooks of Reader move a cursor through the mapping
+ * instead of calling into std::ifstream, and message bodies are never
+ * copied. Drop-in replacement for Reader.
+ */
+class MmapReader : public Reader{
+private:
+    int fd = -1;
+    const char *data = nullptr;
+    const char *cursor = nullptr;
+    const char *end = nullptr;
+    size_t length = 0;
+
+public:
+    /**
+     * Maps the file and advises the kernel that it will be read sequentially
+     * (and backed by huge pages where supported).
+     *
+     * If the file cannot be opened or mapped, prints to standard error and
+     * isValid() returns false.
+     *
+     * @param[in] fileName ITCH 5.0 file to read.
+     */
+    MmapReader(std::string fileName);
+    ~MmapReader() override;
+
+    bool eof() override;
+    bool seek(uint64_t offset, unsigned messageCount) override;
+    void readBytesIntoMessage(const long &) override;
+    void skipBytes(const long &) override;
+    char getKey() override;
+};
+
+
+#endif //ORDER_MATCHING_ENGINE_MMAP_READER_H
@@ -0,0 +1,269 @@
+#include "pcap_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "itch_view.h"
+
+namespace {
+
+constexpr uint32_t PCAP_MAGIC = 0xa1b2c3d4;
+constexpr uint32_t PCAP_MAGIC_NANOS = 0xa1b23c4d;
+constexpr size_t PCAP_HEADER = 24;
+constexpr size_t RECORD_HEADER = 16;
+
+constexpr uint32_t LINK_ETHERNET = 1;
+constexpr uint32_t LINK_RAW = 101;
+constexpr uint32_t LINK_LINUX_SLL = 113;
+
+constexpr size_t MOLD_HEADER = 20;     // session, sequence number, count
+constexpr uint16_t MOLD_END_OF_SESSION = 0xFFFF;
+constexpr uint16_t MAX_MESSAGE = 64;    // largest frame Reader accepts
+
+uint32_t load_le32(const char *p){
+    const auto *b = reinterpret_cast<const unsigned char *>(p);
+    return b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+bool isPcapMagic(uint32_t magic){
+    return magic == PCAP_MAGIC || magic == PCAP_MAGIC_NANOS
+           || __builtin_bswap32(magic) == PCAP_MAGIC || __builtin_bswap32(magic) == PCAP_MAGIC_NANOS;
+}
+
+}
+
+void MoldStats::print(std::ostream &out) const{
+    out << "MoldUDP64: " << messages << " messages in " << moldPackets << " packets ("
+        << packets << " captured, " << heartbeats << " heartbeats, " << skipped << " skipped, "
+        << malformed << " malformed)." << std::endl;
+    out << "MoldUDP64: " << gaps << " sequence gaps, " << missed << " messages missed";
+    if (gaps > 0) {
+        out << " (first at " << firstGap << ", largest " << largestGap << ")";
+    }
+    out << ", " << duplicates << " duplicates dropped, " << sessions << " session changes." << std::endl;
+}
+
+bool detectPcap(const std::string &fileName){
+    std::ifstream in(fileName, std::ios::binary);
+    char magic[4];
+    return in.read(magic, sizeof(magic)) && isPcapMagic(load_le32(magic));
+}
+
+PcapReader::PcapReader(std::string _fileName, uint16_t udpPort) :
+        Reader(std::move(_fileName), false),
+        port(udpPort) {
+    fd = open(fileName.c_str(), O_RDONLY);
+    struct stat st{};
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "The input file: " << fileName << " cannot be open! " << std::endl;
+        return;
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length < PCAP_HEADER) {
+        std::cerr << "The input file: " << fileName << " is not a pcap capture! " << std::endl;
+        return;
+    }
+    void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "The input file: " << fileName << " cannot be mapped! " << std::endl;
+        return;
+    }
+    madvise(mapped, length, MADV_SEQUENTIAL);
+    madvise(mapped, length, MADV_WILLNEED);
+    data = static_cast<const char *>(mapped);
+    end = data + length;
+
+    uint32_t magic = load_le32(data);
+    if (!isPcapMagic(magic)) {
+        std::cerr << "The input file: " << fileName << " is not a pcap capture! " << std::endl;
+        return;
+    }
+    swapped = magic != PCAP_MAGIC && magic != PCAP_MAGIC_NANOS;
+    linkType = recordU32(data + 20) & 0x0fffffff;
+    if (linkType != LINK_ETHERNET && linkType != LINK_RAW && linkType != LINK_LINUX_SLL) {
+        std::cerr << "The input file: " << fileName << " has unsupported link type " << linkType << "! " << std::endl;
+        return;
+    }
+    packet = data + PCAP_HEADER;
+    std::cout << "Mapped " << fileName << " (" << length << " bytes) to read MoldUDP64 ITCH 5.0. messages." << std::endl;
+    validFile = true;
+    start = time(0);
+}
+
+uint32_t PcapReader::recordU32(const char *p) const{
+    uint32_t v = load_le32(p);
+    return swapped ? __builtin_bswap32(v) : v;
+}
+
+const char *PcapReader::nextDatagram(size_t &size){
+    while (end - packet >= static_cast<long>(RECORD_HEADER)) {
+        size_t captured = recordU32(packet + 8);
+        const char *frame = packet + RECORD_HEADER;
+        if (static_cast<size_t>(end - frame) < captured) {
+            // capture cut off mid packet
+            packet = end;
+            return nullptr;
+        }
+        packet = frame + captured;
+        stats.packets++;
+
+        // link layer
+        const char *ip = frame;
+        size_t left = captured;
+        uint16_t etherType = 0x0800;
+        if (linkType == LINK_ETHERNET) {
+            size_t header = 14;
+            if (left < header) { stats.skipped++; continue; }
+            etherType = itch::load_be16(frame + 12);
+            while ((etherType == 0x8100 || etherType == 0x88a8) && left >= header + 4) {
+                etherType = itch::load_be16(frame + header + 2);
+                header += 4;
+            }
+            ip += header;
+            left -= header;
+        } else if (linkType == LINK_LINUX_SLL) {
+            if (left < 16) { stats.skipped++; continue; }
+            etherType = itch::load_be16(frame + 14);
+            ip += 16;
+            left -= 16;
+        }
+        if (etherType != 0x0800 || left < 20 || (ip[0] >> 4) != 4) {
+            stats.skipped++;
+            continue;
+        }
+
+        // IPv4, unfragmented UDP only
+        size_t ipHeader = (ip[0] & 0x0f) * 4;
+        size_t ipLength = std::min<size_t>(itch::load_be16(ip + 2), left);
+        bool fragment = (itch::load_be16(ip + 6) & 0x3fff) != 0;
+        if (ip[9] != 17 || fragment || ipHeader < 20 || ipLength < ipHeader + 8) {
+            stats.skipped++;
+            continue;
+        }
+        const char *udp = ip + ipHeader;
+        if (port != 0 && itch::load_be16(udp + 2) != port) {
+            stats.skipped++;
+            continue;
+        }
+        size_t udpLength = std::min<size_t>(itch::load_be16(udp + 4), ipLength - ipHeader);
+        if (udpLength < 8) {
+            stats.skipped++;
+            continue;
+        }
+        size = udpLength - 8;
+        return udp + 8;
+    }
+    packet = end;
+    return nullptr;
+}
+
+bool PcapReader::nextPacket(){
+    size_t size;
+    while (const char *mold = nextDatagram(size)) {
+        if (size < MOLD_HEADER) {
+            stats.skipped++;
+            continue;
+        }
+        uint64_t sequence = itch::load_be64(mold + 10);
+        uint16_t messageCount = itch::load_be16(mold + 18);
+        if (!started || std::memcmp(session, mold, sizeof(session)) != 0) {
+            stats.sessions += started ? 1 : 0;
+            std::memcpy(session, mold, sizeof(session));
+            expected = sequence;
+            started = true;
+        }
+        if (messageCount == MOLD_END_OF_SESSION) {
+            stats.endOfSession++;
+            continue;
+        }
+        // a heartbeat carries the next sequence number, so it reveals gaps too
+        if (sequence > expected) {
+            uint64_t lost = sequence - expected;
+            stats.firstGap = stats.gaps == 0 ? expected : stats.firstGap;
+            stats.gaps++;
+            stats.missed += lost;
+            stats.largestGap = std::max<unsigned long>(stats.largestGap, lost);
+            expected = sequence;
+        }
+        if (messageCount == 0) {
+            stats.heartbeats++;
+            continue;
+        }
+
+        // message blocks must tile the packet
+        const char *first = mold + MOLD_HEADER;
+        const char *payloadEnd = mold + size;
+        const char *cursor = first;
+        const char *fresh = nullptr;
+        uint64_t duplicates = expected - sequence;
+        for (uint16_t i = 0; i < messageCount && cursor != nullptr; ++i) {
+            if (i == duplicates) fresh = cursor;
+            uint16_t blockLength = payloadEnd - cursor >= 2 ? itch::load_be16(cursor) : 0;
+            bool fits = blockLength > 0 && blockLength <= MAX_MESSAGE && payloadEnd - cursor - 2 >= blockLength;
+            cursor = fits ? cursor + 2 + blockLength : nullptr;
+        }
+        if (cursor == nullptr) {
+            stats.malformed++;
+            continue;
+        }
+        stats.moldPackets++;
+        if (duplicates >= messageCount) {
+            stats.duplicates += messageCount;
+            continue;
+        }
+        stats.duplicates += duplicates;
+        stats.messages += messageCount - duplicates;
+        expected = sequence + messageCount;
+        block = fresh;
+        blockEnd = cursor;
+        return true;
+    }
+    return false;
+}
+
+bool PcapReader::eof(){
+    while (block >= blockEnd) {
+        if (!validFile || !nextPacket()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PcapReader::seek(uint64_t, unsigned){
+    return false;
+}
+
+void PcapReader::readBytesIntoMessage(const long &size){
+    if (eof() || blockEnd - block < size) {
+        // cannot happen for validated packets
+        block = blockEnd;
+        validFile = false;
+        return;
+    }
+    message = block;
+    block += size;
+}
+
+void PcapReader::skipBytes(const long &size){
+    block = (blockEnd - block < size) ? blockEnd : block + size;
+}
+
+char PcapReader::getKey(){
+    return eof() ? 0 : *block++;
+}
+
+PcapReader::~PcapReader(){
+    if (data != nullptr) {
+        munmap(const_cast<char *>(data), length);
+    }
+    if (fd >= 0) {
+        close(fd);
+        std::cout << "File " << fileName << " has been closed" << std::endl;
+        std::cout << "Finished, processed " << count << " messages in " << difftime(time(0),start) << "seconds."  << std::endl;
+        stats.print(std::cout);
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef ORDER_MATCHING_ENGINE_PCAP_READER_H
+#define ORDER_MATCHING_ENGINE_PCAP_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include "reader.h"
+
+/**
+ * Sequencing counters of a MoldUDP64 stream.
+ */
+struct MoldStats{
+    unsigned long packets = 0;         // pcap records
+    unsigned long moldPackets = 0;     // MoldUDP64 packets with messages
+    unsigned long heartbeats = 0;
+    unsigned long endOfSession = 0;
+    unsigned long sessions = 0;        // session changes after the first
+    unsigned long skipped = 0;         // not UDP/IPv4, other port, fragments
+    unsigned long malformed = 0;       // message blocks overrun the packet
+    unsigned long messages = 0;        // messages handed out
+    unsigned long duplicates = 0;      // already seen messages dropped
+    unsigned long gaps = 0;            // sequence gaps
+    unsigned long missed = 0;          // messages lost in gaps
+    unsigned long largestGap = 0;
+    uint64_t firstGap = 0;             // first missing sequence number
+
+    void print(std::ostream &out) const;
+};
+
+/**
+ * True if the file starts with a libpcap (not pcapng) header.
+ */
+bool detectPcap(const std::string &fileName);
+
+/**
+ * ITCH 5.0 reader over a libpcap capture of a MoldUDP64 feed.
+ *
+ * Maps the capture and walks Ethernet/IPv4/UDP packets in place. A
+ * MoldUDP64 message block is a 2-byte big-endian length followed by the
+ * message, i.e. exactly the frame format of the ITCH file, so the byte
+ * hooks of Reader simply move a cursor through the message blocks of the
+ * current packet and nextFrame() hands out ITCH payloads without copying.
+ *
+ * Sequence numbers are tracked per session: gaps are counted, messages
+ * already seen (retransmissions, A/B feed duplicates) are dropped, and the
+ * counters are printed when the reader is destroyed. Drop-in replacement
+ * for Reader; seek() is not supported.
+ */
+class PcapReader : public Reader{
+private:
+    int fd = -1;
+    const char *data = nullptr;
+    const char *end = nullptr;
+    size_t length = 0;
+    const char *packet = nullptr;      // next pcap record
+    const char *block = nullptr;       // message blocks of the current packet
+    const char *blockEnd = nullptr;
+    bool swapped = false;
+    uint32_t linkType = 0;
+    uint16_t port;
+
+    char session[10];
+    bool started = false;
+    uint64_t expected = 0;             // next sequence number
+    MoldStats stats;
+
+    uint32_t recordU32(const char *p) const;
+    // payload of the next UDP packet, nullptr at end of capture
+    const char *nextDatagram(size_t &size);
+    bool nextPacket();
+
+public:
+    /**
+     * If the file cannot be opened or is not a supported capture, prints to
+     * standard error and isValid() returns false.
+     *
+     * @param[in] fileName libpcap capture (Ethernet, Linux cooked or raw IP).
+     * @param[in] udpPort only read datagrams to this port; 0 for all.
+     */
+    PcapReader(std::string fileName, uint16_t udpPort = 0);
+    ~PcapReader() override;
+
+    bool eof() override;
+    bool seek(uint64_t offset, unsigned messageCount) override;
+    void readBytesIntoMessage(const long &) override;
+    void skipBytes(const long &) override;
+    char getKey() override;
+
+    const MoldStats &getStats() const{ return stats; }
+};
+
+
+#endif //ORDER_MATCHING_ENGINE_PCAP_READER_H
@@ -1,13 +1,19 @@
 #include "reader.h"
+#include "time_index.h"
 
 Reader::Reader(std::string _fileName) :
+        Reader(std::move(_fileName), true) {}
+
+Reader::Reader(std::string _fileName, bool openStream) :
         fileName(std::move(_fileName)) {
-    file.open(fileName);
-    if (!file.is_open()) {
-        std::cerr << "The input file: " << fileName << " cannot be open! " << std::endl;
-    } else {
-        std::cout << "Opened " << fileName << " to read ITCH 5.0. messages." << std::endl;
-        validFile = true;
+    if (openStream) {
+        file.open(fileName);
+        if (!file.is_open()) {
+            std::cerr << "The input file: " << fileName << " cannot be open! " << std::endl;
+        } else {
+            std::cout << "Opened " << fileName << " to read ITCH 5.0. messages." << std::endl;
+            validFile = true;
+        }
     }
     start = time(0);
 }
@@ -22,7 +28,8 @@ void Reader::printProgress(){
 }
 
 void Reader::readBytesIntoMessage(const long &size){
-    file.read(message, size);
+    file.read(buffer, size);
+    message = buffer;
 }
 
 void Reader::skipBytes(const long &size){
@@ -35,187 +42,73 @@ char Reader::getKey(){
     return key;
 }
 
-Message Reader::createMessage(){
+const char *Reader::nextFrame(uint16_t &length){
+    if (eof()) {
+        return nullptr;
+    }
+    readBytesIntoMessage(2);
+    if (!validFile || file.fail()) {
+        return nullptr;
+    }
+    length = parse_uint16(message);
+    if (length == 0 || length > sizeof(buffer)) {
+        std::cerr << "Frame of length " << length << " is not ITCH 5.0: abort" << std::endl;
+        validFile = false;
+        return nullptr;
+    }
+    readBytesIntoMessage(length);
+    if (!validFile || file.fail()) {
+        return nullptr;
+    }
+    frameOffset += 2 + length;
     printProgress();
-    Message msg;
-    skipBytes(2);
-    char key = getKey();
-//    std::cout << "key: " << key << "   Pos: "<<  this->file.tellg() << std::endl;
-    char ticker[9];
-    strncpy(ticker, stock.c_str(), 8); ticker[8] = 0;
-    int debug = 0;
-
-    switch(key){
-        uint64_t timeStamp, orderId, oldOrderId, newOrderId;
-        uint32_t size, price, execSize, cancSize, newSize, newPrice;
-
-        // debug
-        uint64_t locateCode, trackingNumb;
-        char eventCode;
-        char direction;
-        char mpid[5];
-
-
-        case 'S':
-            readBytesIntoMessage(11);
-            break;
-        case 'R':
-            readBytesIntoMessage(38);
-            break;
-        case 'H':
-            readBytesIntoMessage(24);
-            break;
-        case 'T':
-            readBytesIntoMessage(19);
-            break;
-        case 'z':
-            readBytesIntoMessage(19);
-            break;
-        case 'Y':
-            readBytesIntoMessage(19);
-            break;
-        case 'L':
-            readBytesIntoMessage(25);
-            break;
-        case 'V':
-            readBytesIntoMessage(34);
-            break;
-        case 'W':
-            readBytesIntoMessage(11);
-            break;
-        case 'K':
-            readBytesIntoMessage(27);
-            break;
-        case 'J':
-            readBytesIntoMessage(34);
-            break;
-        case 'h':
-            readBytesIntoMessage(20);
-            break;
-        case 'A':
-            readBytesIntoMessage(35);
-            timeStamp = parse_ts(message+4);
-            orderId = parse_uint64(message+10);
-            direction = message[18];
-            size = parse_uint32(message+19);
-            strncpy(ticker, message+23, 8); ticker[8] = 0;
-            price = parse_uint32(message+31);
-            msg.setType(key);
-            msg.setTimeStamp(static_cast<time_type>(timeStamp));
-            msg.setId(static_cast<id_type>(orderId));
-            msg.setSide(static_cast<side_type>(direction == 'S'));
-            msg.setRemSize(static_cast<size_type>(size));
-            msg.setPrice(static_cast<price_type>(price));
-            msg.setTicker(std::string(ticker));
-            if (debug == 1)
-            {
-                std::cout << "ticker:       " << ticker << std::endl;
-                msg.print();
-            }
-            break;
-        case 'F':
-            readBytesIntoMessage(39);
-            timeStamp = parse_ts(message+4);
-            orderId = parse_uint64(message+10);
-            direction = message[18];
-            size = parse_uint32(message+19);
-            strncpy(ticker, message+23, 8); ticker[8] = 0;
-            price = parse_uint32(message+31);
-            strncpy(mpid, message+35, 4); mpid[4] = 0;
-            msg.setType(key);
-            msg.setTimeStamp(static_cast<time_type>(timeStamp));
-            msg.setId(static_cast<id_type>(orderId));
-            msg.setSide(static_cast<side_type>(direction == 'S'));
-            msg.setRemSize(static_cast<size_type>(size));
-            msg.setPrice(static_cast<price_type>(price));
-            msg.setMPID(*mpid);
-            msg.setTicker(std::string(ticker));
-            if (debug == 1)
-            {
-                std::cout << "ticker:       " << ticker << std::endl;
-                msg.print();
-            }
-            break;
-        case 'E':
-            readBytesIntoMessage(30);
-            break;
-        case 'C':
-            readBytesIntoMessage(35);
-            break;
-        case 'X':
-            readBytesIntoMessage(22);
-            timeStamp = parse_ts(message+4);
-            orderId = parse_uint64(message+10);
-            cancSize = parse_uint32(message+18);
-            msg.setType(key);
-            msg.setTimeStamp(static_cast<time_type>(timeStamp));
-            msg.setId(static_cast<id_type>(orderId));
-            msg.setCancSize(static_cast<size_type>(cancSize));
-            if (debug == 1)
-                msg.print();
-            break;
-        case 'D':
-            readBytesIntoMessage(18);
-            timeStamp = parse_ts(message+4);
-            orderId = parse_uint64(message+10);
-            msg.setType(key);
-            msg.setTimeStamp(static_cast<time_type>(timeStamp));
-            msg.setId(static_cast<id_type>(orderId));
-            if (debug == 1)
-                msg.print();
-            break;
-        case 'U':
-            readBytesIntoMessage(34);
-//            timeStamp = parse_ts(message+4);
-//            oldOrderId = parse_uint64(message+10);
-//            newOrderId = parse_uint64(message+18);
-//            newSize = parse_uint32(message+26);
-//            newPrice = parse_uint32(message+30);
-//            msg.setType(key);
-//            msg.setTimeStamp(static_cast<time_type>(timeStamp));
-//            msg.setId(static_cast<id_type>(newOrderId));
-//            msg.setOldId(static_cast<id_type>(oldOrderId));
-//            msg.setRemSize(static_cast<size_type>(newSize));
-//            msg.setPrice(static_cast<price_type>(newPrice));
-            break;
-        case 'P':
-            readBytesIntoMessage(43);
-//            timeStamp = parse_ts(message+4);
-//            orderId = parse_uint64(message+10);
-//            direction = message[18];
-//            size = parse_uint32(message+19);
-//            strncpy(ticker, message+23, 8); ticker[8] = 0;
-//            price = parse_uint32(message+31);
-//            msg.setType(key);
-//            msg.setTimeStamp(static_cast<time_type>(timeStamp));
-//            msg.setId(static_cast<id_type>(orderId));
-//            msg.setSide(static_cast<side_type>(direction == 'S'));
-//            msg.setExecSize(static_cast<size_type>(size));
-//            msg.setPrice(static_cast<price_type>(price));
-            break;
-        case 'Q':
-            readBytesIntoMessage(39);
-            break;
-        case 'B':
-            readBytesIntoMessage(18);
-            break;
-        case 'I':
-            readBytesIntoMessage(49);
-            break;
-        case 'N':
-            readBytesIntoMessage(19);
-            break;
-        default:
-            if (!eof()) {
-                std::cerr << "Type " << key << " not found: abort" << std::endl;
-                validFile = false;
-            }
-            break;
+    return message;
+}
+
+namespace {
+
+/*
+    Decodes the frames the book cares about into a Message.
+*/
+struct MessageDecoder{
+    Message &msg;
+
+    void on(const itch::AddOrderView &add){
+        msg.setType(add.type());
+        msg.setTimeStamp(static_cast<time_type>(add.timestamp()));
+        msg.setId(static_cast<id_type>(add.orderRef()));
+        msg.setSide(static_cast<side_type>(add.side() == 'S'));
+        msg.setRemSize(static_cast<size_type>(add.shares()));
+        msg.setPrice(static_cast<price_type>(add.price()));
+        msg.setTicker(std::string(add.stock().str()));
+    }
+    void on(const itch::AddOrderMpidView &add){
+        on(static_cast<const itch::AddOrderView &>(add));
+        msg.setMPID(*add.attribution().data());
+    }
+    void on(const itch::OrderCancelView &cancel){
+        msg.setType(cancel.type());
+        msg.setTimeStamp(static_cast<time_type>(cancel.timestamp()));
+        msg.setId(static_cast<id_type>(cancel.orderRef()));
+        msg.setCancSize(static_cast<size_type>(cancel.cancelledShares()));
+    }
+    void on(const itch::OrderDeleteView &del){
+        msg.setType(del.type());
+        msg.setTimeStamp(static_cast<time_type>(del.timestamp()));
+        msg.setId(static_cast<id_type>(del.orderRef()));
     }
+};
 
-//    if (strcmp(ticker, stock.c_str()) != 0) {
-//        return {};
-//    }
+}
+
+Message Reader::createMessage(){
+    Message msg;
+    uint16_t length;
+    const char *frame = nextFrame(length);
+    if (frame != nullptr) {
+        MessageDecoder decoder{msg};
+        itch::dispatch(decoder, frame, length);
+    }
     return msg;
 }
 
@@ -223,6 +116,31 @@ bool Reader::eof(){
     return file.eof();
 }
 
+bool Reader::seek(uint64_t offset, unsigned messageCount){
+    if (!validFile) {
+        return false;
+    }
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(offset));
+    if (file.fail()) {
+        validFile = false;
+        return false;
+    }
+    // a seek to the very end leaves eof() unset until the next read
+    file.peek();
+    frameOffset = offset;
+    count = messageCount;
+    return true;
+}
+
+bool Reader::seekToTime(uint64_t timestamp, const TimeIndex &index){
+    const TimeIndexEntry *entry = index.find(timestamp);
+    if (entry == nullptr) {
+        return seek(0, 0);
+    }
+    return seek(entry->offset, static_cast<unsigned>(entry->messageCount));
+}
+
 bool Reader::isValid() const{
     return validFile;
 }
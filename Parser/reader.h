@@ -9,16 +9,33 @@
 #include <cinttypes>
 #include <cstring>
 #include "message.h"
+#include "itch_dispatch.h"
+
+class TimeIndex;
 
 class Reader{
 private:
-    std::string fileName;
     std::ifstream file;
-    std::string stock;
+    char buffer[64];
+
+protected:
+    std::string fileName;
     unsigned count = 0;
-    char message[64];
+    // points at the bytes of the current message; subclasses may point it
+    // straight into their own storage instead of copying into buffer
+    const char *message = buffer;
     bool validFile = false;
     time_t start;
+    // offset of the next frame in the (decompressed) ITCH stream
+    uint64_t frameOffset = 0;
+
+    /**
+     * Constructor for subclasses that provide their own byte source.
+     *
+     * @param[in] fileName input file, only used for reporting.
+     * @param[in] openStream open fileName with the std::ifstream.
+     */
+    Reader(std::string fileName, bool openStream);
 
 public:
 
@@ -28,7 +45,45 @@ public:
     virtual ~Reader();
 
     Message createMessage();
-    bool eof();
+
+    /**
+     * Reads the next length-prefixed frame without decoding it.
+     *
+     * The returned pointer addresses the message type byte and stays valid
+     * until the next read; wrap it in one of the itch:: views to decode
+     * fields on demand. Nothing is allocated or copied beyond what the byte
+     * source itself needs.
+     *
+     * @param[out] length size of the frame in bytes.
+     * @return the frame, or nullptr at end of file or on a malformed frame.
+     */
+    const char *nextFrame(uint16_t &length);
+    virtual bool eof();
+
+    /**
+     * Moves to the frame starting at byte 'offset' of the ITCH stream.
+     *
+     * @param[in] offset frame offset, e.g. from a TimeIndex.
+     * @param[in] messageCount frames before that offset; restores the
+     *            message counter.
+     * @return false if the reader cannot move there.
+     */
+    virtual bool seek(uint64_t offset, unsigned messageCount);
+
+    /**
+     * Jumps to the last index entry at or before 'timestamp', so that the
+     * next frame is the first one the index can place no earlier than any
+     * frame before it. Frames between that entry and 'timestamp' are still
+     * returned; callers that need the exact time skip them.
+     *
+     * @param[in] timestamp ITCH timestamp, nanoseconds since midnight.
+     * @param[in] index TimeIndex built over this reader's file.
+     */
+    bool seekToTime(uint64_t timestamp, const TimeIndex &index);
+
+    // offset of the next frame
+    uint64_t getOffset() const{ return frameOffset; }
+    unsigned getCount() const{ return count; }
     void printProgress();
     virtual void readBytesIntoMessage(const long &);
     virtual void skipBytes(const long &);
@@ -0,0 +1,19 @@
+#include "reader_factory.h"
+
+#include "mmap_reader.h"
+#include "compressed_reader.h"
+#include "pcap_reader.h"
+
+std::unique_ptr<Reader> openReader(const std::string &fileName, bool memoryMapped){
+    Compression compression = detectCompression(fileName);
+    if (compression != Compression::NONE) {
+        return std::make_unique<CompressedReader>(fileName, compression);
+    }
+    if (detectPcap(fileName)) {
+        return std::make_unique<PcapReader>(fileName);
+    }
+    if (memoryMapped) {
+        return std::make_unique<MmapReader>(fileName);
+    }
+    return std::make_unique<Reader>(fileName);
+}
@@ -0,0 +1,21 @@
+#ifndef ORDER_MATCHING_ENGINE_READER_FACTORY_H
+#define ORDER_MATCHING_ENGINE_READER_FACTORY_H
+
+#include <memory>
+#include <string>
+#include "reader.h"
+
+/**
+ * Opens the right reader for an ITCH 5.0 input.
+ *
+ * gzip and zstd files are recognised from their header (not their
+ * extension) and read through CompressedReader, pcap captures of a
+ * MoldUDP64 feed through PcapReader; raw files through
+ * MmapReader, or the std::ifstream based Reader if memoryMapped is false.
+ *
+ * @param[in] fileName ITCH 5.0 file, raw, compressed or captured.
+ * @param[in] memoryMapped map raw files instead of streaming them.
+ */
+std::unique_ptr<Reader> openReader(const std::string &fileName, bool memoryMapped = true);
+
+#endif //ORDER_MATCHING_ENGINE_READER_FACTORY_H
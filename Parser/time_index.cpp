@@ -0,0 +1,132 @@
+#include "time_index.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "itch_view.h"
+#include "reader_factory.h"
+#include "compressed_reader.h"
+
+constexpr char TimeIndexHeader::MAGIC[8];
+
+TimeIndex::TimeIndex(const std::string &indexFileName, const std::string &sourceFileName){
+    std::ifstream in(indexFileName, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "The index file: " << indexFileName << " cannot be open! " << std::endl;
+        return;
+    }
+    TimeIndexHeader header{};
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, TimeIndexHeader::MAGIC, sizeof(header.magic)) != 0
+        || header.version != TimeIndexHeader::VERSION
+        || header.entrySize != sizeof(TimeIndexEntry)) {
+        std::cerr << "The index file: " << indexFileName << " has an unsupported format! " << std::endl;
+        return;
+    }
+    entries.resize(header.entryCount);
+    in.read(reinterpret_cast<char *>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(TimeIndexEntry)));
+    if (!in) {
+        std::cerr << "The index file: " << indexFileName << " is truncated! " << std::endl;
+        entries.clear();
+        return;
+    }
+    sourceSize = header.sourceSize;
+    if (!sourceFileName.empty()) {
+        // cheap check only: compressed sources would need a full
+        // decompression to verify anything more
+        std::ifstream source(sourceFileName, std::ios::binary | std::ios::ate);
+        bool sameSize = source.is_open() && (detectCompression(sourceFileName) != Compression::NONE
+                                             || static_cast<uint64_t>(source.tellg()) == sourceSize);
+        if (!sameSize) {
+            std::cerr << "The index file: " << indexFileName << " was not built from "
+                      << sourceFileName << "! " << std::endl;
+            entries.clear();
+            return;
+        }
+    }
+    valid = true;
+}
+
+TimeIndex TimeIndex::build(const std::string &sourceFileName, const std::string &indexFileName,
+                           uint64_t everyMessages, uint64_t everyNanos){
+    TimeIndex index;
+    std::unique_ptr<Reader> reader = openReader(sourceFileName);
+    if (!reader->isValid()) {
+        return index;
+    }
+    everyMessages = everyMessages == 0 ? 1 : everyMessages;
+    uint64_t latest = 0;
+    uint64_t lastCount = 0;
+    uint64_t lastTimestamp = 0;
+    while (!reader->eof() && reader->isValid()) {
+        uint64_t offset = reader->getOffset();
+        uint64_t messageCount = reader->getCount();
+        uint16_t length;
+        const char *frame = reader->nextFrame(length);
+        if (frame == nullptr || length < itch::View::Timestamp::offset + itch::View::Timestamp::width) {
+            continue;
+        }
+        uint64_t timestamp = itch::View::Timestamp::get(frame);
+        if (index.entries.empty() || messageCount - lastCount >= everyMessages
+            || timestamp >= lastTimestamp + everyNanos) {
+            // timestamp of the entry covers every frame before it
+            index.entries.push_back({std::max(latest, timestamp), offset, messageCount});
+            lastCount = messageCount;
+            lastTimestamp = timestamp;
+        }
+        latest = std::max(latest, timestamp);
+    }
+    if (!reader->isValid()) {
+        // an index over a partial day would pass for the whole one
+        std::cerr << "The input file: " << sourceFileName << " is corrupt or truncated, no index written! " << std::endl;
+        return index;
+    }
+    // the size on disk, which is what the constructor checks against; the
+    // reader's offset is past the pcap headers or in decompressed bytes
+    std::ifstream source(sourceFileName, std::ios::binary | std::ios::ate);
+    index.sourceSize = source.is_open() ? static_cast<uint64_t>(source.tellg()) : 0;
+
+    TimeIndexHeader header{};
+    std::memcpy(header.magic, TimeIndexHeader::MAGIC, sizeof(header.magic));
+    header.version = TimeIndexHeader::VERSION;
+    header.entrySize = sizeof(TimeIndexEntry);
+    header.entryCount = index.entries.size();
+    header.sourceSize = index.sourceSize;
+    header.everyMessages = everyMessages;
+    header.everyNanos = everyNanos;
+    std::ofstream out(indexFileName, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(index.entries.data()),
+              static_cast<std::streamsize>(index.entries.size() * sizeof(TimeIndexEntry)));
+    out.close();
+    if (!out) {
+        std::cerr << "The index file: " << indexFileName << " cannot be written! " << std::endl;
+        return index;
+    }
+    std::cout << "Indexed " << sourceFileName << " at " << index.entries.size()
+              << " points in " << indexFileName << std::endl;
+    index.valid = true;
+    return index;
+}
+
+const TimeIndexEntry *TimeIndex::find(uint64_t timestamp) const{
+    auto next = std::upper_bound(entries.begin(), entries.end(), timestamp,
+                                 [](uint64_t t, const TimeIndexEntry &entry){ return t < entry.timestamp; });
+    return next == entries.begin() ? nullptr : &*(next - 1);
+}
+
+bool parseTimeOfDay(const std::string &text, uint64_t &nanos){
+    unsigned hours = 0, minutes = 0;
+    double seconds = 0;
+    int read = 0;
+    int fields = std::sscanf(text.c_str(), "%u:%u%n:%lf%n", &hours, &minutes, &read, &seconds, &read);
+    if (fields < 2 || static_cast<size_t>(read) != text.size()
+        || hours > 23 || minutes > 59 || seconds < 0 || seconds >= 60) {
+        return false;
+    }
+    nanos = (hours * 3600ULL + minutes * 60ULL) * 1000000000ULL
+            + static_cast<uint64_t>(seconds * 1e9 + 0.5);
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef ORDER_MATCHING_ENGINE_TIME_INDEX_H
+#define ORDER_MATCHING_ENGINE_TIME_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * One seek point of a TimeIndex.
+ */
+struct TimeIndexEntry{
+    uint64_t timestamp;      // no frame before 'offset' is later than this
+    uint64_t offset;         // byte offset of the frame's length prefix
+    uint64_t messageCount;   // frames before 'offset'
+};
+
+/**
+ * Header of a time index file, followed by entryCount TimeIndexEntry
+ * records in native byte order.
+ */
+struct TimeIndexHeader{
+    static constexpr char MAGIC[8] = {'O', 'M', 'E', 'T', 'I', 'D', 'X', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t entryCount;
+    uint64_t sourceSize;        // bytes of the ITCH stream (decompressed)
+    uint64_t everyMessages;
+    uint64_t everyNanos;
+};
+
+/**
+ * Sidecar seek index of an ITCH 5.0 file: a (timestamp, offset, message
+ * count) entry at the first frame, then every 'everyMessages' frames or
+ * 'everyNanos' of exchange time, whichever comes first.
+ *
+ * Entry timestamps are the running maximum of the frame timestamps, so the
+ * index stays sorted even if a feed is not strictly time ordered.
+ */
+class TimeIndex{
+private:
+    std::vector<TimeIndexEntry> entries;
+    uint64_t sourceSize = 0;
+    bool valid = false;
+
+public:
+    TimeIndex() = default;
+
+    /**
+     * Loads an index file. If sourceFileName is not empty, the index must
+     * have been built over a stream of the same size. On any mismatch the
+     * reason is printed to standard error and isValid() returns false.
+     */
+    TimeIndex(const std::string &indexFileName, const std::string &sourceFileName = "");
+
+    /**
+     * Indexes an ITCH file (raw or compressed) and writes the index to
+     * indexFileName.
+     *
+     * @return the index; isValid() is false if either file failed.
+     */
+    static TimeIndex build(const std::string &sourceFileName, const std::string &indexFileName,
+                           uint64_t everyMessages = 100000,
+                           uint64_t everyNanos = 1000000000ULL);
+
+    /**
+     * @return the last entry at or before 'timestamp', or nullptr if
+     *         'timestamp' is before the first frame.
+     */
+    const TimeIndexEntry *find(uint64_t timestamp) const;
+
+    bool isValid() const{ return valid; }
+    const std::vector<TimeIndexEntry> &getEntries() const{ return entries; }
+};
+
+/**
+ * Parses "HH:MM[:SS[.fraction]]" into nanoseconds since midnight.
+ */
+bool parseTimeOfDay(const std::string &text, uint64_t &nanos);
+
+#endif //ORDER_MATCHING_ENGINE_TIME_INDEX_H
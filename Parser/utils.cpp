@@ -36,21 +36,21 @@ uint64_t bswap_64(uint64_t value){
             static_cast<uint64_t>(bswap_32(static_cast<uint32_t>((value) >> 32))));
 }
 
-uint16_t parse_uint16(char * a){
-    return bswap_16(*(reinterpret_cast<uint16_t *>(a)));
+uint16_t parse_uint16(const char * a){
+    return bswap_16(*(reinterpret_cast<const uint16_t *>(a)));
 }
 
-uint32_t parse_uint32(char * a){
-    return bswap_32(*(reinterpret_cast<uint32_t *>(a)));
+uint32_t parse_uint32(const char * a){
+    return bswap_32(*(reinterpret_cast<const uint32_t *>(a)));
 }
 
-uint64_t parse_uint64(char * a){
-    return bswap_64(*(reinterpret_cast<uint64_t *>(a)));
+uint64_t parse_uint64(const char * a){
+    return bswap_64(*(reinterpret_cast<const uint64_t *>(a)));
 }
 
-uint64_t parse_ts(char * a){
-    return (((static_cast<uint64_t>(bswap_16(*(reinterpret_cast<uint16_t *>(a))))) << 32) |
-            static_cast<uint64_t>(bswap_32(*(reinterpret_cast<uint32_t *>(a+2)))));
+uint64_t parse_ts(const char * a){
+    return (((static_cast<uint64_t>(bswap_16(*(reinterpret_cast<const uint16_t *>(a))))) << 32) |
+            static_cast<uint64_t>(bswap_32(*(reinterpret_cast<const uint32_t *>(a+2)))));
 }
 
 long GetNanoSecondInTime(const char *time){
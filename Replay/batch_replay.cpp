@@ -0,0 +1,180 @@
+#include "batch_replay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <glob.h>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "../Parser/reader_factory.h"
+#include "../Parser/frame_filter.h"
+#include "../Parser/book_event.h"
+#include "../book_updater.h"
+
+void BatchReport::print(std::ostream &out) const{
+    DayReport total;
+    unsigned failed = 0;
+    double busy = 0;
+    for (const DayReport &day : days) {
+        out << day.path << ": ";
+        if (!day.ok) {
+            out << "failed" << std::endl;
+            failed++;
+            continue;
+        }
+        out << day.messages << " messages, " << day.adds << " adds, " << day.deletes << " deletes, "
+            << day.fills << " fills, " << day.peakOrders << " peak orders, "
+            << (day.seconds > 0 ? day.messages / day.seconds / 1e6 : 0) << " M msg/s" << std::endl;
+        total.messages += day.messages;
+        total.adds += day.adds;
+        total.deletes += day.deletes;
+        total.fills += day.fills;
+        total.peakOrders = std::max(total.peakOrders, day.peakOrders);
+        busy += day.seconds;
+    }
+    out << "Replayed " << days.size() - failed << " of " << days.size() << " days in " << seconds
+        << " seconds (" << busy << " seconds of replay): " << total.messages << " messages, "
+        << total.adds << " adds, " << total.deletes << " deletes, " << total.fills << " fills." << std::endl;
+    out << "Throughput " << (seconds > 0 ? total.messages / seconds / 1e6 : 0) << " M msg/s, peak "
+        << total.peakOrders << " orders in one day, peak resident memory "
+        << peakResidentBytes / (1 << 20) << " MB." << std::endl;
+}
+
+BatchReplay::BatchReplay(std::vector<std::string> _paths,
+                         std::vector<std::string> symbolFilters,
+                         const Options &_options) :
+        paths(std::move(_paths)),
+        symbols(std::move(symbolFilters)),
+        options(_options) {
+    if (options.workers == 0) {
+        options.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+DayReport BatchReplay::replayDay(const std::string &path) const{
+    DayReport report;
+    report.path = path;
+    auto begin = std::chrono::steady_clock::now();
+    std::unique_ptr<Reader> reader = openReader(path);
+    if (!reader->isValid()) {
+        return report;
+    }
+    FrameFilter filter(symbols);
+    BookUpdater updater;
+    while (!reader->eof() && reader->isValid()) {
+        uint16_t length;
+        const char *frame = reader->nextFrame(length);
+        BookEvent event;
+        if (frame == nullptr) {
+            continue;
+        }
+        report.messages++;
+        if (filter.accept(frame, length) && decodeBookEvent(frame, length, event)) {
+            updater.apply(event);
+        }
+    }
+    report.ok = reader->isValid();
+    report.adds = updater.getTotalAdd();
+    report.deletes = updater.getTotalDelete();
+    report.fills = updater.getTotalExecute();
+    report.peakOrders = updater.getPeakOrders();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return report;
+}
+
+BatchReport BatchReplay::run(){
+    BatchReport report;
+    report.days.resize(paths.size());
+    auto begin = std::chrono::steady_clock::now();
+
+    std::mutex admission;
+    std::condition_variable dayDone;
+    size_t nextDay = 0;
+    unsigned running = 0;
+    auto worker = [&](){
+        while (true) {
+            size_t day;
+            {
+                std::unique_lock<std::mutex> lock(admission);
+                // over budget: wait for another day to finish and free its book
+                dayDone.wait(lock, [&]{
+                    return nextDay >= paths.size() || running == 0 || options.memoryBudget == 0
+                           || residentBytes() <= options.memoryBudget;
+                });
+                if (nextDay >= paths.size()) {
+                    return;
+                }
+                day = nextDay++;
+                running++;
+            }
+            report.days[day] = replayDay(paths[day]);
+            // hand the freed book back to the system for the other workers
+            malloc_trim(0);
+            {
+                std::lock_guard<std::mutex> lock(admission);
+                running--;
+            }
+            dayDone.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    unsigned count = std::min<unsigned>(options.workers, static_cast<unsigned>(std::max<size_t>(paths.size(), 1)));
+    for (unsigned w = 0; w < count; ++w) {
+        workers.emplace_back(worker);
+    }
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    report.peakResidentBytes = static_cast<size_t>(usage.ru_maxrss) * 1024;
+    return report;
+}
+
+std::vector<std::string> BatchReplay::expandInputs(const std::vector<std::string> &inputs){
+    std::vector<std::string> paths;
+    for (const std::string &input : inputs) {
+        if (input.size() > 1 && input[0] == '@') {
+            std::ifstream list(input.substr(1));
+            if (!list.is_open()) {
+                std::cerr << "The list file: " << input.substr(1) << " cannot be open! " << std::endl;
+                continue;
+            }
+            std::vector<std::string> lines;
+            for (std::string line; std::getline(list, line);) {
+                if (!line.empty() && line[0] != '#') lines.push_back(line);
+            }
+            for (const std::string &path : expandInputs(lines)) paths.push_back(path);
+        } else if (input.find_first_of("*?[") != std::string::npos) {
+            glob_t matches{};
+            if (glob(input.c_str(), 0, nullptr, &matches) == 0) {
+                // glob sorts its matches
+                for (size_t i = 0; i < matches.gl_pathc; ++i) paths.emplace_back(matches.gl_pathv[i]);
+            } else {
+                std::cerr << "No input matches " << input << std::endl;
+            }
+            globfree(&matches);
+        } else {
+            paths.push_back(input);
+        }
+    }
+    return paths;
+}
+
+size_t BatchReplay::residentBytes(){
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0, shared = 0;
+    if (!(statm >> pages >> resident >> shared)) {
+        return 0;
+    }
+    // file-backed pages (mapped input files) can be dropped at any time
+    return (resident - std::min(resident, shared)) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
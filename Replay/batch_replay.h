@@ -0,0 +1,84 @@
+#ifndef ORDER_MATCHING_ENGINE_BATCH_REPLAY_H
+#define ORDER_MATCHING_ENGINE_BATCH_REPLAY_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Counters of one replayed day.
+ */
+struct DayReport{
+    std::string path;
+    bool ok = false;
+    unsigned long messages = 0;
+    unsigned long adds = 0;
+    unsigned long deletes = 0;
+    unsigned long fills = 0;        // 'E' and 'C' executions
+    unsigned long peakOrders = 0;   // most orders resting at once
+    double seconds = 0;
+};
+
+/**
+ * Per-day counters and their totals over a batch.
+ */
+struct BatchReport{
+    std::vector<DayReport> days;    // in input order
+    double seconds = 0;             // wall clock of the whole batch
+    size_t peakResidentBytes = 0;   // of the process
+
+    void print(std::ostream &out) const;
+};
+
+/**
+ * Replays many ITCH days concurrently, one independent book per day.
+ *
+ * A fixed pool of workers takes the next day off a shared list; each day
+ * gets its own reader, FrameFilter and BookUpdater (and so its own
+ * CentralOrderBook), which is freed before the worker moves on. With a
+ * memory budget, a worker does not start another day while the resident
+ * size of the process (not counting mapped input files) is above it and
+ * other days are still running.
+ */
+class BatchReplay{
+public:
+    struct Options{
+        unsigned workers = 0;           // 0: one per hardware thread
+        size_t memoryBudget = 0;        // bytes of resident memory, 0: none
+    };
+
+private:
+    std::vector<std::string> paths;
+    std::vector<std::string> symbols;
+    Options options;
+
+    DayReport replayDay(const std::string &path) const;
+
+public:
+    /**
+     * @param[in] paths ITCH 5.0 days (raw, compressed or pcap).
+     * @param[in] symbolFilters symbols to build books for; empty for all.
+     * @param[in] options worker count and memory budget.
+     */
+    BatchReplay(std::vector<std::string> paths,
+                std::vector<std::string> symbolFilters,
+                const Options &options);
+
+    /**
+     * Replays every day; returns when all are done.
+     */
+    BatchReport run();
+
+    /**
+     * Expands shell-style wildcards ("data/2019*.PSX_ITCH50") and list
+     * files ("@days.txt", one path or pattern per line) into sorted paths;
+     * other arguments are kept as they are.
+     */
+    static std::vector<std::string> expandInputs(const std::vector<std::string> &inputs);
+
+    // resident bytes of the process that are not file-backed, 0 if unknown
+    static size_t residentBytes();
+};
+
+#endif //ORDER_MATCHING_ENGINE_BATCH_REPLAY_H
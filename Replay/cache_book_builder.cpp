@@ -0,0 +1,20 @@
+#include "cache_book_builder.h"
+
+#include <chrono>
+
+CacheBookBuilder::CacheBookBuilder(const std::string &cachePath,
+                                   const std::string &sourcePath,
+                                   const std::vector<std::string> &symbolFilters) :
+        cache(cachePath, sourcePath),
+        eventFilter(symbolFilters) {
+}
+
+void CacheBookBuilder::start(){
+    auto begin = std::chrono::steady_clock::now();
+    for (const BookEvent &event : cache) {
+        if (eventFilter.accept(event)) {
+            updater.apply(event);
+        }
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
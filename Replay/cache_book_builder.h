@@ -0,0 +1,47 @@
+#ifndef ORDER_MATCHING_ENGINE_CACHE_BOOK_BUILDER_H
+#define ORDER_MATCHING_ENGINE_CACHE_BOOK_BUILDER_H
+
+#include <string>
+#include <vector>
+
+#include "../Parser/event_cache.h"
+#include "../Parser/frame_filter.h"
+#include "../book_updater.h"
+
+/**
+ * Replays a pre-decoded event cache (see buildEventCache()) into a
+ * CentralOrderBook. Produces the same books as BookBuilder over the source
+ * ITCH file, without reading or decoding a single ITCH frame.
+ */
+class CacheBookBuilder{
+private:
+    EventCache cache;
+    FrameFilter eventFilter;
+    BookUpdater updater;
+    double seconds = 0;
+
+public:
+    /**
+     * @param[in] cachePath event cache to replay.
+     * @param[in] sourcePath ITCH file the cache must have been built from;
+     *            empty to skip the checksum.
+     * @param[in] symbolFilters symbols to build books for; empty for all.
+     */
+    CacheBookBuilder(const std::string &cachePath,
+                     const std::string &sourcePath,
+                     const std::vector<std::string> &symbolFilters);
+
+    bool isValid() const{ return cache.isValid(); }
+
+    /**
+     * Replays every cached event.
+     */
+    void start();
+
+    BookUpdater& getUpdater(){ return updater; }
+    CentralOrderBook& getBook(){ return updater.getBook(); }
+    unsigned long getFiltered() const{ return eventFilter.getDropped(); }
+    double getSeconds() const{ return seconds; }
+};
+
+#endif //ORDER_MATCHING_ENGINE_CACHE_BOOK_BUILDER_H
@@ -0,0 +1,57 @@
+#include "merged_book_builder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+MergedBookBuilder::MergedBookBuilder(const std::vector<std::string> &inputMessagePaths,
+                                     const std::vector<std::string> &symbolFilters,
+                                     bool memoryMapped) :
+        merger(inputMessagePaths, memoryMapped) {
+    for (size_t venue = 0; venue < merger.feedCount(); ++venue) {
+        filters.push_back(std::make_unique<FrameFilter>(symbolFilters));
+        venues.push_back(std::make_unique<BookUpdater>());
+    }
+}
+
+void MergedBookBuilder::start(){
+    auto begin = std::chrono::steady_clock::now();
+    MergedFrame frame;
+    while (merger.next(frame)) {
+        updateBook(frame);
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void MergedBookBuilder::updateBook(const MergedFrame &frame){
+    BookEvent event;
+    if (filters[frame.venue]->accept(frame.frame, frame.length) && decodeBookEvent(frame.frame, frame.length, event)) {
+        venues[frame.venue]->apply(event);
+    }
+}
+
+std::pair<StatusCode, unsigned> MergedBookBuilder::best_bid(const std::string &symbol) const{
+    StatusCode status = StatusCode::SYMBOL_NOT_EXISTS;
+    unsigned price = 0;
+    for (const auto &venue : venues) {
+        auto bid = venue->getBook().best_bid(symbol);
+        if (bid.first == StatusCode::OK) {
+            price = status == StatusCode::OK ? std::max(price, bid.second) : bid.second;
+            status = StatusCode::OK;
+        }
+    }
+    return std::make_pair(status, price);
+}
+
+std::pair<StatusCode, unsigned> MergedBookBuilder::best_ask(const std::string &symbol) const{
+    StatusCode status = StatusCode::SYMBOL_NOT_EXISTS;
+    unsigned price = std::numeric_limits<unsigned>::max();
+    for (const auto &venue : venues) {
+        auto ask = venue->getBook().best_ask(symbol);
+        if (ask.first == StatusCode::OK) {
+            price = std::min(price, ask.second);
+            status = StatusCode::OK;
+        }
+    }
+    return std::make_pair(status, price);
+}
@@ -0,0 +1,60 @@
+#ifndef ORDER_MATCHING_ENGINE_MERGED_BOOK_BUILDER_H
+#define ORDER_MATCHING_ENGINE_MERGED_BOOK_BUILDER_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Parser/feed_merger.h"
+#include "../Parser/frame_filter.h"
+#include "../book_updater.h"
+
+/**
+ * One-pass replay of several venues' ITCH feeds, merged by timestamp.
+ *
+ * Stock locates and order references are only unique within a venue, so
+ * every venue gets its own FrameFilter and BookUpdater (i.e. its own
+ * CentralOrderBook); the consolidated top of book is taken across them.
+ */
+class MergedBookBuilder{
+private:
+    FeedMerger merger;
+    std::vector<std::unique_ptr<FrameFilter>> filters;
+    std::vector<std::unique_ptr<BookUpdater>> venues;
+    double seconds = 0;
+
+public:
+    /**
+     * @param[in] inputMessagePaths one ITCH 5.0 input per venue.
+     * @param[in] symbolFilters symbols to build books for; empty for all.
+     * @param[in] memoryMapped see openReader().
+     */
+    MergedBookBuilder(const std::vector<std::string> &inputMessagePaths,
+                      const std::vector<std::string> &symbolFilters,
+                      bool memoryMapped = true);
+
+    bool isValid() const{ return merger.isValid(); }
+
+    /**
+     * Replays all feeds in timestamp order.
+     */
+    void start();
+
+    /**
+     * Applies one merged frame to the book of its venue.
+     */
+    void updateBook(const MergedFrame &frame);
+
+    unsigned venueCount() const{ return static_cast<unsigned>(venues.size()); }
+    BookUpdater& getVenue(unsigned venue){ return *venues[venue]; }
+
+    // best bid/ask of 'symbol' over all venues that list it
+    std::pair<StatusCode, unsigned> best_bid(const std::string &symbol) const;
+    std::pair<StatusCode, unsigned> best_ask(const std::string &symbol) const;
+
+    unsigned long getFramesRead() const{ return merger.getMerged(); }
+    double getSeconds() const{ return seconds; }
+};
+
+#endif //ORDER_MATCHING_ENGINE_MERGED_BOOK_BUILDER_H
@@ -0,0 +1,110 @@
+#include "parallel_book_builder.h"
+
+#include <chrono>
+#include "../Parser/reader_factory.h"
+
+ParallelBookBuilder::ParallelBookBuilder(const std::string &inputMessagePath,
+                                         const std::vector<std::string> &symbolFilters,
+                                         const Options &_options,
+                                         bool memoryMapped) :
+        options(_options),
+        message_reader(openReader(inputMessagePath, memoryMapped)),
+        frameFilter(symbolFilters) {
+    options.shards = options.shards == 0 ? 1 : options.shards;
+    options.decoders = options.decoders == 0 ? 1 : std::min(options.decoders, options.shards);
+    options.batch = options.batch == 0 ? 1 : options.batch;
+    for (unsigned d = 0; d < options.decoders; ++d) {
+        frameRings.push_back(std::make_unique<SpscRing<RawFrame>>(options.ringCapacity, options.wait));
+    }
+    for (unsigned s = 0; s < options.shards; ++s) {
+        eventRings.push_back(std::make_unique<SpscRing<BookEvent>>(options.ringCapacity, options.wait));
+        shards.push_back(std::make_unique<BookUpdater>());
+    }
+}
+
+void ParallelBookBuilder::decodeWorker(unsigned decoder){
+    SpscRing<RawFrame> &input = *frameRings[decoder];
+    std::vector<RawFrame> frames(options.batch);
+    // pending events per shard fed by this decoder
+    std::vector<std::vector<BookEvent>> pending(options.shards);
+    auto flush = [&](unsigned shard){
+        if (!pending[shard].empty()) {
+            eventRings[shard]->push(pending[shard].data(), pending[shard].size());
+            pending[shard].clear();
+        }
+    };
+    while (size_t n = input.pop(frames.data(), frames.size())) {
+        for (size_t i = 0; i < n; ++i) {
+            BookEvent event;
+            if (decodeBookEvent(frames[i].bytes, frames[i].length, event)) {
+                auto &batch = pending[frames[i].shard];
+                batch.push_back(event);
+                if (batch.size() == options.batch) {
+                    flush(frames[i].shard);
+                }
+            }
+        }
+        if (!input.ready()) {
+            // input went idle: do not hold events back
+            for (unsigned s = decoder; s < options.shards; s += options.decoders) flush(s);
+        }
+    }
+    for (unsigned s = decoder; s < options.shards; s += options.decoders) {
+        flush(s);
+        eventRings[s]->close();
+    }
+}
+
+void ParallelBookBuilder::shardWorker(unsigned shard){
+    SpscRing<BookEvent> &input = *eventRings[shard];
+    BookUpdater &updater = *shards[shard];
+    std::vector<BookEvent> events(options.batch);
+    while (size_t n = input.pop(events.data(), events.size())) {
+        for (size_t i = 0; i < n; ++i) {
+            updater.apply(events[i]);
+        }
+    }
+}
+
+void ParallelBookBuilder::start(){
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned s = 0; s < options.shards; ++s) {
+        threads.emplace_back(&ParallelBookBuilder::shardWorker, this, s);
+    }
+    for (unsigned d = 0; d < options.decoders; ++d) {
+        threads.emplace_back(&ParallelBookBuilder::decodeWorker, this, d);
+    }
+
+    // framer: runs on the calling thread
+    std::vector<std::vector<RawFrame>> pending(options.decoders);
+    while (!message_reader->eof() and message_reader->isValid()) {
+        uint16_t length;
+        const char *frame = message_reader->nextFrame(length);
+        if (frame == nullptr || length > sizeof(RawFrame::bytes)) {
+            continue;
+        }
+        framesRead++;
+        if (!frameFilter.accept(frame, length) || itch::message_lengths[static_cast<unsigned char>(frame[0])] == 0) {
+            continue;
+        }
+        RawFrame raw;
+        raw.length = length;
+        raw.shard = static_cast<uint16_t>(shardOf(itch::View(frame).stockLocate()));
+        std::memcpy(raw.bytes, frame, length);
+        unsigned decoder = raw.shard % options.decoders;
+        pending[decoder].push_back(raw);
+        if (pending[decoder].size() == options.batch) {
+            frameRings[decoder]->push(pending[decoder].data(), pending[decoder].size());
+            pending[decoder].clear();
+        }
+    }
+    for (unsigned d = 0; d < options.decoders; ++d) {
+        frameRings[d]->push(pending[d].data(), pending[d].size());
+        frameRings[d]->close();
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
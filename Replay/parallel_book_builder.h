@@ -0,0 +1,85 @@
+#ifndef ORDER_MATCHING_ENGINE_PARALLEL_BOOK_BUILDER_H
+#define ORDER_MATCHING_ENGINE_PARALLEL_BOOK_BUILDER_H
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Parser/reader.h"
+#include "../Parser/frame_filter.h"
+#include "../Parser/book_event.h"
+#include "../book_updater.h"
+#include "spsc_ring.h"
+
+/**
+ * Pipelined multi-threaded ITCH replay.
+ *
+ *   reader/framer  --frames-->  decode workers  --events-->  book shards
+ *   (caller thread)             (D threads)                  (N threads)
+ *
+ * The framer reads and filters frames and routes each one by stock locate:
+ * locate -> shard (locate % N) -> decode worker (shard % D). Every shard is
+ * fed by exactly one decode worker, so all links are SPSC rings, and every
+ * symbol always travels the same FIFO path, which preserves per-symbol
+ * message order. Each shard owns a BookUpdater, i.e. a disjoint set of
+ * OrderBooks; order references never cross shards because every ITCH
+ * order message carries the locate of its stock.
+ */
+class ParallelBookBuilder{
+public:
+    struct Options{
+        unsigned shards = 4;
+        unsigned decoders = 1;
+        WaitPolicy wait = WaitPolicy::SPIN;
+        size_t batch = 64;               // items moved per ring operation
+        size_t ringCapacity = 1 << 14;   // items per ring
+    };
+
+    // frame copied out of the reader's storage
+    struct RawFrame{
+        uint16_t length;
+        uint16_t shard;
+        char bytes[60];
+    };
+
+private:
+    Options options;
+    std::unique_ptr<Reader> message_reader;
+    FrameFilter frameFilter;
+    std::vector<std::unique_ptr<SpscRing<RawFrame>>> frameRings;   // one per decoder
+    std::vector<std::unique_ptr<SpscRing<BookEvent>>> eventRings;  // one per shard
+    std::vector<std::unique_ptr<BookUpdater>> shards;
+    unsigned long framesRead = 0;
+    double seconds = 0;
+
+    void decodeWorker(unsigned decoder);
+    void shardWorker(unsigned shard);
+
+public:
+    /**
+     * @param[in] inputMessagePath ITCH 5.0 file to replay, raw or
+     *            gzip/zstd compressed.
+     * @param[in] symbolFilters symbols to build books for; empty for all.
+     * @param[in] options thread counts, batching and waiting.
+     * @param[in] memoryMapped read through MmapReader instead of Reader.
+     */
+    ParallelBookBuilder(const std::string &inputMessagePath,
+                        const std::vector<std::string> &symbolFilters,
+                        const Options &options,
+                        bool memoryMapped = true);
+
+    /**
+     * Replays the whole file; returns when every shard has drained.
+     */
+    void start();
+
+    unsigned shardCount() const{ return static_cast<unsigned>(shards.size()); }
+    BookUpdater& getShard(unsigned shard){ return *shards[shard]; }
+    // shard holding the books of stock locate 'locate'
+    unsigned shardOf(uint16_t locate) const{ return locate % options.shards; }
+    unsigned long getFramesRead() const{ return framesRead; }
+    double getSeconds() const{ return seconds; }
+};
+
+#endif //ORDER_MATCHING_ENGINE_PARALLEL_BOOK_BUILDER_H
@@ -0,0 +1,128 @@
+#include "replay_pacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+uint64_t steadyNanos(){
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// sleeping is only trusted up to this close to the deadline
+constexpr uint64_t spinWindow = 200000;
+
+}
+
+PaceClock::PaceClock(bool useTsc){
+    nanosBase = steadyNanos();
+#if defined(__x86_64__) || defined(__i386__)
+    if (useTsc) {
+        tscBase = __rdtsc();
+        // calibrate over a few milliseconds
+        uint64_t until = nanosBase + 5000000;
+        uint64_t nanos;
+        while ((nanos = steadyNanos()) < until) {}
+        uint64_t ticks = __rdtsc() - tscBase;
+        nanosPerTick = ticks > 0 ? static_cast<double>(nanos - nanosBase) / ticks : 0;
+    }
+#else
+    (void) useTsc;
+#endif
+}
+
+uint64_t PaceClock::now() const{
+#if defined(__x86_64__) || defined(__i386__)
+    if (nanosPerTick > 0) {
+        return nanosBase + static_cast<uint64_t>((__rdtsc() - tscBase) * nanosPerTick);
+    }
+#endif
+    return steadyNanos();
+}
+
+unsigned LatencyHistogram::bucketOf(uint64_t value){
+    if (value < subBuckets) {
+        return static_cast<unsigned>(value);
+    }
+    unsigned exponent = 63 - __builtin_clzll(value);          // >= subBits
+    unsigned sub = static_cast<unsigned>(value >> (exponent - subBits)) & (subBuckets - 1);
+    return (exponent - subBits + 1) * subBuckets + sub;
+}
+
+uint64_t LatencyHistogram::upperBound(unsigned bucket){
+    if (bucket < subBuckets) {
+        return bucket;
+    }
+    unsigned exponent = bucket / subBuckets + subBits - 1;
+    uint64_t sub = bucket % subBuckets;
+    uint64_t low = (uint64_t(1) << exponent) | (sub << (exponent - subBits));
+    return low + (uint64_t(1) << (exponent - subBits)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value){
+    counts[bucketOf(value)]++;
+    total++;
+    maximum = std::max(maximum, value);
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const{
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(fraction * total + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+    uint64_t seen = 0;
+    for (unsigned bucket = 0; bucket < counts.size(); ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return std::min(upperBound(bucket), maximum);
+        }
+    }
+    return maximum;
+}
+
+ReplayPacer::ReplayPacer(double _speed, WaitPolicy _policy) :
+        speed(_speed > 0 ? _speed : 1.0),
+        policy(_policy) {
+}
+
+uint64_t ReplayPacer::wait(uint64_t timestamp){
+    paced++;
+    if (!anchored) {
+        firstTimestamp = timestamp;
+        anchor = clock.now();
+        anchored = true;
+        lateness.record(0);
+        return 0;
+    }
+    // frames may be slightly out of order: never due before the anchor
+    uint64_t offset = timestamp > firstTimestamp ? timestamp - firstTimestamp : 0;
+    uint64_t due = anchor + static_cast<uint64_t>(offset / speed);
+    uint64_t now = clock.now();
+    if (now >= due) {
+        lateness.record(now - due);
+        return now - due;
+    }
+    if (policy == WaitPolicy::PARK && due - now > spinWindow) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(due - now - spinWindow));
+    }
+    while (clock.now() < due) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    lateness.record(0);
+    return 0;
+}
+
+void ReplayPacer::print(std::ostream &out) const{
+    out << "Paced " << paced << " messages at " << speed << "x: lateness p50 "
+        << lateness.percentile(0.5) / 1000 << " us, p90 " << lateness.percentile(0.9) / 1000
+        << " us, p99 " << lateness.percentile(0.99) / 1000 << " us, p99.9 "
+        << lateness.percentile(0.999) / 1000 << " us, max " << lateness.max() / 1000 << " us" << std::endl;
+}
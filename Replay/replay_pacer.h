@@ -0,0 +1,92 @@
+#ifndef ORDER_MATCHING_ENGINE_REPLAY_PACER_H
+#define ORDER_MATCHING_ENGINE_REPLAY_PACER_H
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include "spsc_ring.h"
+
+/**
+ * Monotonic nanosecond clock for pacing: the TSC (calibrated against
+ * steady_clock once) on x86, steady_clock elsewhere. Reading the TSC costs
+ * a few nanoseconds instead of a vDSO call.
+ */
+class PaceClock{
+private:
+    uint64_t tscBase = 0;
+    uint64_t nanosBase = 0;
+    double nanosPerTick = 0;       // 0: use steady_clock
+
+public:
+    explicit PaceClock(bool useTsc = true);
+    uint64_t now() const;
+};
+
+/**
+ * Log-linear latency histogram: 16 linear sub-buckets per power of two,
+ * i.e. values are kept within ~6% of their true size, in fixed memory.
+ */
+class LatencyHistogram{
+private:
+    static constexpr unsigned subBits = 4;
+    static constexpr unsigned subBuckets = 1u << subBits;
+    std::array<uint64_t, 64 * subBuckets> counts{};
+    uint64_t total = 0;
+    uint64_t maximum = 0;
+
+    static unsigned bucketOf(uint64_t value);
+    static uint64_t upperBound(unsigned bucket);
+
+public:
+    void record(uint64_t value);
+    // smallest recorded bucket bound below which 'fraction' of values fall
+    uint64_t percentile(double fraction) const;
+    uint64_t count() const{ return total; }
+    uint64_t max() const{ return maximum; }
+};
+
+/**
+ * Replays frames on the schedule given by their ITCH timestamps.
+ *
+ * The first frame anchors exchange time to the wall clock; frame t is then
+ * due at anchor + (t - first) / speed. wait() holds the caller until the
+ * frame is due, busy-waiting on PaceClock (SPIN), or sleeping until shortly
+ * before and spinning the rest (PARK), so the bursts of the open and the
+ * close are replayed as they happened. A frame that is already overdue is
+ * released at once and its lateness recorded.
+ */
+class ReplayPacer{
+private:
+    double speed;
+    WaitPolicy policy;
+    PaceClock clock;
+    bool anchored = false;
+    uint64_t firstTimestamp = 0;
+    uint64_t anchor = 0;
+    uint64_t paced = 0;
+    LatencyHistogram lateness;
+
+public:
+    /**
+     * @param[in] speed multiple of exchange time, e.g. 1 (real time) or 10.
+     * @param[in] policy how to wait for a frame that is not yet due.
+     */
+    explicit ReplayPacer(double speed = 1.0, WaitPolicy policy = WaitPolicy::SPIN);
+
+    /**
+     * Blocks until the frame with ITCH timestamp 'timestamp' is due.
+     *
+     * @return nanoseconds the caller was behind schedule, 0 if on time.
+     */
+    uint64_t wait(uint64_t timestamp);
+
+    const LatencyHistogram &getLateness() const{ return lateness; }
+    uint64_t getPaced() const{ return paced; }
+
+    /**
+     * Prints lateness percentiles over all paced frames.
+     */
+    void print(std::ostream &out) const;
+};
+
+#endif //ORDER_MATCHING_ENGINE_REPLAY_PACER_H
@@ -0,0 +1,165 @@
+#ifndef ORDER_MATCHING_ENGINE_SPSC_RING_H
+#define ORDER_MATCHING_ENGINE_SPSC_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * How a thread waits on an empty (consumer) or full (producer) ring.
+ *
+ * - SPIN: busy-polls, lowest latency, burns a core per waiting thread.
+ * - PARK: polls briefly, then sleeps until the other side signals.
+ */
+enum class WaitPolicy : unsigned char {
+    SPIN,
+    PARK
+};
+
+/**
+ * Bounded lock-free single-producer/single-consumer ring.
+ *
+ * Items are written and published in batches: one release store of the
+ * head index makes a whole batch visible, and the consumer takes
+ * everything available with one acquire load. Capacity is rounded up to a
+ * power of two. The producer close()s the ring at end of stream; pop
+ * returns 0 once the ring is closed and drained.
+ */
+template<typename T>
+class SpscRing{
+private:
+    static constexpr size_t cacheLine = 64;
+
+    std::vector<T> slots;
+    size_t mask;
+    WaitPolicy policy;
+
+    alignas(cacheLine) std::atomic<size_t> head{0};   // written by producer
+    size_t cachedTail = 0;                            // producer's view of tail
+    alignas(cacheLine) std::atomic<size_t> tail{0};   // written by consumer
+    size_t cachedHead = 0;                            // consumer's view of head
+    alignas(cacheLine) std::atomic<bool> closed{false};
+    std::atomic<bool> sleeping{false};
+    std::mutex parkMutex;
+    std::condition_variable parkSignal;
+
+    static size_t roundUp(size_t n){
+        size_t capacity = 2;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+    void wait(unsigned &spins){
+        ++spins;
+        if (policy == WaitPolicy::SPIN || spins < 256) {
+            if (spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+            } else {
+                std::this_thread::yield();
+            }
+            return;
+        }
+        std::unique_lock<std::mutex> lock(parkMutex);
+        sleeping.store(true, std::memory_order_seq_cst);
+        parkSignal.wait_for(lock, std::chrono::microseconds(200));
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    void wake(){
+        if (policy == WaitPolicy::PARK && sleeping.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            parkSignal.notify_one();
+        }
+    }
+
+public:
+    explicit SpscRing(size_t capacity, WaitPolicy policy = WaitPolicy::SPIN) :
+            slots(roundUp(capacity)), mask(roundUp(capacity) - 1), policy(policy) {}
+
+    size_t capacity() const{ return slots.size(); }
+
+    /**
+     * Producer: copies 'count' items in, waiting for room as needed.
+     */
+    void push(const T *items, size_t count){
+        size_t h = head.load(std::memory_order_relaxed);
+        unsigned spins = 0;
+        while (count > 0) {
+            size_t room = slots.size() - (h - cachedTail);
+            if (room == 0) {
+                cachedTail = tail.load(std::memory_order_acquire);
+                if (slots.size() == h - cachedTail) {
+                    wake();
+                    wait(spins);
+                }
+                continue;
+            }
+            size_t n = room < count ? room : count;
+            for (size_t i = 0; i < n; ++i) {
+                slots[(h + i) & mask] = items[i];
+            }
+            h += n;
+            items += n;
+            count -= n;
+            head.store(h, std::memory_order_release);
+            wake();
+        }
+    }
+
+    /**
+     * Producer: no more items will be pushed.
+     */
+    void close(){
+        closed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(parkMutex);
+        parkSignal.notify_one();
+    }
+
+    /**
+     * Consumer: moves up to 'max' items into 'out', waiting while the ring
+     * is empty and open.
+     *
+     * @return number of items taken, 0 once closed and drained.
+     */
+    size_t pop(T *out, size_t max){
+        size_t t = tail.load(std::memory_order_relaxed);
+        unsigned spins = 0;
+        while (cachedHead == t) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (cachedHead != t) {
+                break;
+            }
+            if (closed.load(std::memory_order_acquire)) {
+                cachedHead = head.load(std::memory_order_acquire);
+                if (cachedHead == t) {
+                    return 0;
+                }
+                break;
+            }
+            wait(spins);
+        }
+        size_t n = cachedHead - t;
+        n = n < max ? n : max;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = slots[(t + i) & mask];
+        }
+        tail.store(t + n, std::memory_order_release);
+        wake();
+        return n;
+    }
+
+    /**
+     * Consumer: true if an item can be popped without waiting.
+     */
+    bool ready(){
+        return head.load(std::memory_order_acquire) != tail.load(std::memory_order_relaxed);
+    }
+};
+
+#endif //ORDER_MATCHING_ENGINE_SPSC_RING_H
@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "../OrderMatcher/orderbook.hh"
+
+/*
+    Cancel latency against the depth of the price level the orders rest in.
+    Every round fills one bid level with 'depth' orders, then cancels all
+    of them in random order (timed) and looks each one up beforehand
+    (timed separately).
+    Usage: cancel_bench [cancels_per_depth]
+*/
+int main(int argc, char **argv){
+    unsigned long cancels = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    std::mt19937 random(42);
+    std::cout << "depth      cancel ns   lookup ns" << std::endl;
+    for (unsigned depth : {1u, 10u, 100u, 1000u, 10000u}) {
+        OrderBook book("cancel_bench", BookMode::PASSIVE);
+        std::vector<unsigned> ids(depth);
+        std::iota(ids.begin(), ids.end(), 1u);
+        unsigned rounds = std::max<unsigned long>(1, cancels / depth);
+        std::chrono::nanoseconds cancelTime{0}, lookupTime{0};
+        unsigned long found = 0;
+        for (unsigned round = 0; round < rounds; ++round) {
+            for (unsigned id : ids) {
+                Order order(id, 1, 1000, 100, OrderSide::BUY, OrderType::LIMIT);
+                book.add_order(order);
+            }
+            std::shuffle(ids.begin(), ids.end(), random);
+
+            auto begin = std::chrono::steady_clock::now();
+            for (unsigned id : ids) {
+                found += book.get_order(id).has_value();
+            }
+            auto middle = std::chrono::steady_clock::now();
+            for (unsigned id : ids) {
+                book.delete_order(id);
+            }
+            auto end = std::chrono::steady_clock::now();
+            lookupTime += middle - begin;
+            cancelTime += end - middle;
+        }
+        double total = static_cast<double>(rounds) * depth;
+        std::cout << depth << "\t" << cancelTime.count() / total << "\t" << lookupTime.count() / total
+                  << (found == total ? "" : "  (lookups missed)") << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../OrderMatcher/orderbook.hh"
+
+/*
+    Cost of a top-10 depth snapshot of both sides against the depth of the
+    book: each side rests 'levels' levels of a few orders, then every
+    round adds and deletes orders (some inside the top levels, some behind
+    them) and takes a snapshot (timed).
+    Usage: depth_bench [rounds]
+*/
+namespace {
+
+double run(unsigned levels, unsigned rounds, unsigned long &checksum){
+    std::mt19937 random(7);
+    OrderBook book("depth_bench", BookMode::PASSIVE);
+    OrderId id = 1;
+    std::vector<OrderId> resting;
+    auto add = [&](OrderSide side, unsigned level){
+        unsigned price = side == OrderSide::BUY ? 100000 - 100 * level : 100100 + 100 * level;
+        Order order(id, 1, price, 100, side, OrderType::LIMIT);
+        book.add_order(order);
+        resting.push_back(id++);
+    };
+    for (unsigned level = 0; level < levels; ++level) {
+        for (unsigned i = 0; i < 4; ++i) {
+            add(OrderSide::BUY, level);
+            add(OrderSide::SELL, level);
+        }
+    }
+    DepthSnapshot<10> snapshot;
+    std::chrono::nanoseconds time{0};
+    for (unsigned round = 0; round < rounds; ++round) {
+        // one update in four lands in the top ten levels
+        OrderSide side = random() % 2 ? OrderSide::BUY : OrderSide::SELL;
+        add(side, random() % 4 == 0 ? random() % 10 : random() % levels);
+        size_t index = random() % resting.size();
+        book.delete_order(resting[index]);
+        resting[index] = resting.back();
+        resting.pop_back();
+        auto begin = std::chrono::steady_clock::now();
+        book.snapshot(snapshot);
+        time += std::chrono::steady_clock::now() - begin;
+        checksum += snapshot.bid_levels + snapshot.asks[0].quantity;
+    }
+    return static_cast<double>(time.count()) / rounds;
+}
+
+}
+
+int main(int argc, char **argv){
+    unsigned rounds = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    unsigned long checksum = 0;
+    for (unsigned levels : {10u, 100u, 1000u, 10000u}) {
+        std::cout << levels << " levels: " << run(levels, rounds, checksum) << " ns/snapshot" << std::endl;
+    }
+    return checksum == 0;
+}
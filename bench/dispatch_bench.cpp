@@ -0,0 +1,161 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../Parser/message.h"
+#include "../Parser/itch_dispatch.h"
+#include "itch_synth.h"
+
+/*
+    Parse cost of the former switch-based Reader::createMessage against the
+    schema-generated dispatch table, over a file held in memory so that
+    only decoding is measured. Usage: dispatch_bench [itch_file].
+*/
+
+namespace {
+
+// the switch as it was in Reader::createMessage, reading from memory
+Message legacy_parse(const char *&cursor){
+    Message msg;
+    cursor += 2;
+    char key = *cursor++;
+    const char *message = cursor;
+    char ticker[9];
+    char mpid[5];
+    auto take = [&](long n){ message = cursor; cursor += n; };
+    switch(key){
+        case 'S': take(11); break;
+        case 'R': take(38); break;
+        case 'H': take(24); break;
+        case 'Y': take(19); break;
+        case 'L': take(25); break;
+        case 'V': take(34); break;
+        case 'W': take(11); break;
+        case 'K': take(27); break;
+        case 'J': take(34); break;
+        case 'h': take(20); break;
+        case 'A':
+        case 'F':
+            take(key == 'A' ? 35 : 39);
+            strncpy(ticker, message+23, 8); ticker[8] = 0;
+            msg.setType(key);
+            msg.setTimeStamp(static_cast<time_type>(parse_ts(message+4)));
+            msg.setId(static_cast<id_type>(parse_uint64(message+10)));
+            msg.setSide(static_cast<side_type>(message[18] == 'S'));
+            msg.setRemSize(static_cast<size_type>(parse_uint32(message+19)));
+            msg.setPrice(static_cast<price_type>(parse_uint32(message+31)));
+            if (key == 'F') {
+                strncpy(mpid, message+35, 4); mpid[4] = 0;
+                msg.setMPID(*mpid);
+            }
+            msg.setTicker(std::string(ticker));
+            break;
+        case 'E': take(30); break;
+        case 'C': take(35); break;
+        case 'X':
+            take(22);
+            msg.setType(key);
+            msg.setTimeStamp(static_cast<time_type>(parse_ts(message+4)));
+            msg.setId(static_cast<id_type>(parse_uint64(message+10)));
+            msg.setCancSize(static_cast<size_type>(parse_uint32(message+18)));
+            break;
+        case 'D':
+            take(18);
+            msg.setType(key);
+            msg.setTimeStamp(static_cast<time_type>(parse_ts(message+4)));
+            msg.setId(static_cast<id_type>(parse_uint64(message+10)));
+            break;
+        case 'U': take(34); break;
+        case 'P': take(43); break;
+        case 'Q': take(39); break;
+        case 'B': take(18); break;
+        case 'I': take(49); break;
+        case 'N': take(19); break;
+        default: break;
+    }
+    return msg;
+}
+
+// same decode as Reader's table-driven createMessage
+struct MessageDecoder{
+    Message msg;
+    void on(const itch::AddOrderView &add){
+        msg.setType(add.type());
+        msg.setTimeStamp(static_cast<time_type>(add.timestamp()));
+        msg.setId(static_cast<id_type>(add.orderRef()));
+        msg.setSide(static_cast<side_type>(add.side() == 'S'));
+        msg.setRemSize(static_cast<size_type>(add.shares()));
+        msg.setPrice(static_cast<price_type>(add.price()));
+        msg.setTicker(std::string(add.stock().str()));
+    }
+    void on(const itch::OrderCancelView &cancel){
+        msg.setType(cancel.type());
+        msg.setTimeStamp(static_cast<time_type>(cancel.timestamp()));
+        msg.setId(static_cast<id_type>(cancel.orderRef()));
+        msg.setCancSize(static_cast<size_type>(cancel.cancelledShares()));
+    }
+    void on(const itch::OrderDeleteView &del){
+        msg.setType(del.type());
+        msg.setTimeStamp(static_cast<time_type>(del.timestamp()));
+        msg.setId(static_cast<id_type>(del.orderRef()));
+    }
+};
+
+// zero-copy consumer touching the same fields
+struct ViewSink{
+    uint64_t sum = 0;
+    void on(const itch::AddOrderView &add){ sum += add.orderRef() + add.shares() + add.price() + add.stock().key(); }
+    void on(const itch::OrderCancelView &cancel){ sum += cancel.orderRef() + cancel.cancelledShares(); }
+    void on(const itch::OrderDeleteView &del){ sum += del.orderRef(); }
+};
+
+template<typename F>
+double timed(F &&f){
+    auto begin = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+}
+
+int main(int argc, char **argv){
+    std::string path = argc > 1 ? argv[1] : "./synthetic.ITCH50";
+    if(argc <= 1){
+        itch_synth::generate(path, 20000000);
+    }
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const char *end = data.data() + data.size();
+
+    unsigned long frames = 0, legacyDecoded = 0, tableDecoded = 0;
+    double legacy = timed([&]{
+        for (const char *cursor = data.data(); cursor < end; ++frames) {
+            if (!legacy_parse(cursor).isEmpty()) legacyDecoded++;
+        }
+    });
+    double table = timed([&]{
+        for (const char *cursor = data.data(); cursor < end;) {
+            uint16_t length = itch::load_be16(cursor);
+            MessageDecoder decoder;
+            itch::dispatch(decoder, cursor + 2, length);
+            if (!decoder.msg.isEmpty()) tableDecoded++;
+            cursor += 2 + length;
+        }
+    });
+    ViewSink sink;
+    double views = timed([&]{
+        for (const char *cursor = data.data(); cursor < end;) {
+            uint16_t length = itch::load_be16(cursor);
+            itch::dispatch(sink, cursor + 2, length);
+            cursor += 2 + length;
+        }
+    });
+    std::cout << frames << " frames, " << legacyDecoded << " decoded" << std::endl;
+    std::cout << "switch -> Message : " << frames / legacy / 1e6 << " M frames/s" << std::endl;
+    std::cout << "table  -> Message : " << frames / table / 1e6 << " M frames/s" << std::endl;
+    std::cout << "table  -> views   : " << frames / views / 1e6 << " M frames/s (checksum " << sink.sum % 1000 << ")" << std::endl;
+    return legacyDecoded == tableDecoded ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+#ifndef ORDER_MATCHING_ENGINE_ITCH_SYNTH_H
+#define ORDER_MATCHING_ENGINE_ITCH_SYNTH_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Synthetic ITCH 5.0 day used by the benchmarks when no real file is given.
+ *
+ * Writes the 2-byte length-prefixed file format produced by Nasdaq/PSX with
+ * a stock directory, system events and a realistic mix of order messages
+ * (adds, deletes, cancels, executions, replaces, trades) over a set of
+ * symbols. Prices random-walk per symbol and timestamps increase.
+ */
+namespace itch_synth {
+
+class FrameWriter{
+    std::vector<char> frame;
+public:
+    FrameWriter &type(char t){ frame.clear(); frame.push_back(t); return *this; }
+    FrameWriter &u8(char v){ frame.push_back(v); return *this; }
+    FrameWriter &u16(uint16_t v){ return be(v, 2); }
+    FrameWriter &u32(uint32_t v){ return be(v, 4); }
+    FrameWriter &u48(uint64_t v){ return be(v, 6); }
+    FrameWriter &u64(uint64_t v){ return be(v, 8); }
+    FrameWriter &alpha(const std::string &s, size_t width){
+        for (size_t i = 0; i < width; ++i) frame.push_back(i < s.size() ? s[i] : ' ');
+        return *this;
+    }
+    FrameWriter &be(uint64_t v, int width){
+        for (int i = width - 1; i >= 0; --i) frame.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+        return *this;
+    }
+    const std::vector<char> &bytes() const{ return frame; }
+    // length-prefixed frame as stored in the ITCH file format
+    void flush(std::ostream &out) const{
+        char len[2] = {static_cast<char>(frame.size() >> 8), static_cast<char>(frame.size() & 0xff)};
+        out.write(len, 2);
+        out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+    }
+};
+
+inline std::vector<std::string> symbols(size_t n){
+    static const char *base[] = {"AAPL", "MSFT", "TSLA", "AMZN"};
+    std::vector<std::string> out;
+    for (size_t i = 0; i < n; ++i) {
+        if (i < 4) {
+            out.emplace_back(base[i]);
+        } else {
+            std::string s = "S";
+            for (size_t k = i; k; k /= 26) s.push_back(static_cast<char>('A' + k % 26));
+            out.push_back(s);
+        }
+    }
+    return out;
+}
+
+/**
+ * Writes 'messages' order messages over 'nSymbols' symbols to 'path'.
+ * Returns the number of frames written (including directory/system frames).
+ */
+inline uint64_t generate(const std::string &path, uint64_t messages, size_t nSymbols = 64, uint32_t seed = 7){
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::mt19937_64 rng(seed);
+    FrameWriter w;
+    uint64_t ts = 4ULL * 3600 * 1000000000ULL;
+    uint64_t frames = 0;
+    auto tick = [&](){ ts += 1 + rng() % 20000; return ts; };
+
+    w.type('S').u16(0).u16(0).u48(tick()).u8('O').flush(out); ++frames;
+    auto syms = symbols(nSymbols);
+    for (size_t i = 0; i < syms.size(); ++i) {
+        w.type('R').u16(static_cast<uint16_t>(i + 1)).u16(0).u48(tick()).alpha(syms[i], 8)
+         .u8('Q').u8('N').u32(100).u8('N').u8('C').alpha("Z ", 2).u8('P').u8('N').u8('N').u8('1')
+         .u8('N').u32(0).u8('N').flush(out);
+        ++frames;
+    }
+    w.type('S').u16(0).u16(0).u48(tick()).u8('Q').flush(out); ++frames;
+
+    struct Live{ uint64_t ref; uint16_t locate; uint32_t shares; uint32_t price; char side; };
+    std::vector<Live> live;
+    std::vector<uint32_t> mid(syms.size(), 1000000);
+    uint64_t nextRef = 1;
+    for (uint64_t m = 0; m < messages; ++m, ++frames) {
+        unsigned roll = static_cast<unsigned>(rng() % 100);
+        if (live.size() < 64 || roll < 40) {
+            uint16_t s = static_cast<uint16_t>(rng() % syms.size());
+            // quotes move on the cent grid, as for any stock above $1
+            mid[s] += (static_cast<uint32_t>(rng() % 3) - 1) * 100;
+            char side = (rng() & 1) ? 'B' : 'S';
+            uint32_t off = static_cast<uint32_t>(rng() % 50) * 100;
+            uint32_t price = side == 'B' ? mid[s] - 100 - off : mid[s] + 100 + off;
+            uint32_t shares = 100 * static_cast<uint32_t>(1 + rng() % 10);
+            Live o{nextRef++, static_cast<uint16_t>(s + 1), shares, price, side};
+            if (roll % 10 == 0) {
+                w.type('F').u16(o.locate).u16(0).u48(tick()).u64(o.ref).u8(side).u32(shares)
+                 .alpha(syms[s], 8).u32(price).alpha("MPID", 4);
+            } else {
+                w.type('A').u16(o.locate).u16(0).u48(tick()).u64(o.ref).u8(side).u32(shares)
+                 .alpha(syms[s], 8).u32(price);
+            }
+            live.push_back(o);
+            w.flush(out);
+            continue;
+        }
+        size_t pick = rng() % live.size();
+        Live &o = live[pick];
+        bool gone = false;
+        if (roll < 75) {
+            w.type('D').u16(o.locate).u16(0).u48(tick()).u64(o.ref);
+            gone = true;
+        } else if (roll < 82) {
+            uint32_t cut = o.shares > 100 ? 100 : o.shares;
+            w.type('X').u16(o.locate).u16(0).u48(tick()).u64(o.ref).u32(cut);
+            o.shares -= cut;
+            gone = o.shares == 0;
+        } else if (roll < 90) {
+            uint32_t ex = o.shares > 100 ? 100 : o.shares;
+            w.type('E').u16(o.locate).u16(0).u48(tick()).u64(o.ref).u32(ex).u64(nextRef * 3);
+            o.shares -= ex;
+            gone = o.shares == 0;
+        } else if (roll < 92) {
+            uint32_t ex = o.shares;
+            w.type('C').u16(o.locate).u16(0).u48(tick()).u64(o.ref).u32(ex).u64(nextRef * 3)
+             .u8('Y').u32(o.price);
+            gone = true;
+        } else if (roll < 98) {
+            uint64_t newRef = nextRef++;
+            uint32_t price = o.side == 'B' ? o.price - 100 : o.price + 100;
+            w.type('U').u16(o.locate).u16(0).u48(tick()).u64(o.ref).u64(newRef).u32(o.shares).u32(price);
+            o.ref = newRef;
+            o.price = price;
+        } else {
+            w.type('P').u16(o.locate).u16(0).u48(tick()).u64(0).u8('B').u32(100)
+             .alpha(syms[o.locate - 1], 8).u32(o.price).u64(nextRef * 3);
+        }
+        w.flush(out);
+        if (gone) {
+            live[pick] = live.back();
+            live.pop_back();
+        }
+    }
+    w.type('S').u16(0).u16(0).u48(tick()).u8('C').flush(out); ++frames;
+    return frames;
+}
+
+/**
+ * Re-frames an ITCH file as a libpcap capture of a MoldUDP64 feed
+ * (Ethernet/IPv4/UDP to 'port'), 'perPacket' messages per packet.
+ * Every 'dropEvery'-th packet is left out and every 'repeatEvery'-th
+ * packet is sent twice; 0 disables either. Returns the packets written.
+ */
+inline uint64_t mold_pcap(const std::string &itchPath, const std::string &pcapPath, unsigned perPacket = 8,
+                          unsigned dropEvery = 0, unsigned repeatEvery = 0, uint16_t port = 26477){
+    std::ifstream in(itchPath, std::ios::binary);
+    std::ofstream out(pcapPath, std::ios::binary | std::ios::trunc);
+    auto le32 = [&](uint32_t v){ for (int i = 0; i < 4; ++i) out.put(static_cast<char>(v >> (8 * i))); };
+    auto le16 = [&](uint16_t v){ out.put(static_cast<char>(v)); out.put(static_cast<char>(v >> 8)); };
+    le32(0xa1b2c3d4); le16(2); le16(4); le32(0); le32(0); le32(65535); le32(1);
+
+    uint64_t sequence = 1, packets = 0, built = 0;
+    std::vector<char> blocks;
+    unsigned count = 0;
+    auto emit = [&](){
+        uint16_t udpLength = static_cast<uint16_t>(8 + 20 + blocks.size());
+        FrameWriter w;
+        w.type(0).be(0, 5).be(0, 6).u16(0x0800)                 // Ethernet
+         .u8(0x45).u8(0).u16(20 + udpLength).u16(0).u16(0x4000) // IPv4, don't fragment
+         .u8(64).u8(17).u16(0).u32(0x0a000001).u32(0xe0000001)
+         .u16(port).u16(port).u16(udpLength).u16(0)             // UDP
+         .alpha("SESSION001", 10).u64(sequence).u16(static_cast<uint16_t>(count));
+        std::vector<char> frame(w.bytes());
+        frame.insert(frame.end(), blocks.begin(), blocks.end());
+        ++built;
+        unsigned copies = (dropEvery && built % dropEvery == 0) ? 0 : (repeatEvery && built % repeatEvery == 0) ? 2 : 1;
+        for (unsigned c = 0; c < copies; ++c, ++packets) {
+            le32(static_cast<uint32_t>(packets)); le32(0);
+            le32(static_cast<uint32_t>(frame.size())); le32(static_cast<uint32_t>(frame.size()));
+            out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        }
+        sequence += count;
+        blocks.clear();
+        count = 0;
+    };
+    char len[2];
+    while (in.read(len, 2)) {
+        size_t n = (static_cast<unsigned char>(len[0]) << 8) | static_cast<unsigned char>(len[1]);
+        blocks.insert(blocks.end(), len, len + 2);
+        size_t at = blocks.size();
+        blocks.resize(at + n);
+        in.read(blocks.data() + at, static_cast<std::streamsize>(n));
+        if (++count == perPacket) emit();
+    }
+    if (count > 0) emit();
+    return packets;
+}
+
+} // namespace itch_synth
+
+#endif //ORDER_MATCHING_ENGINE_ITCH_SYNTH_H
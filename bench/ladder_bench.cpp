@@ -0,0 +1,106 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "../OrderMatcher/price_ladder.hh"
+
+/*
+    Price level operations of one book side: the PriceLadder against the
+    std::set + std::unordered_map pair it replaced. Every step adds a level
+    near a drifting mid price or removes one, then reads the best price;
+    every 16th step sweeps the best level, as a marketable order would.
+    Usage: ladder_bench [steps]
+*/
+namespace {
+
+// the previous representation: ordered prices plus a level map
+class SetMapLevels{
+    private:
+        std::set<unsigned, std::greater<unsigned>> prices;
+        std::unordered_map<unsigned, OrderQueue> pool;
+    public:
+        bool empty() const{ return prices.empty(); }
+        unsigned best() const{ return *prices.begin(); }
+        void add(unsigned price){
+            if(pool.try_emplace(price).second){
+                prices.insert(price);
+            }
+        }
+        void erase(unsigned price){
+            if(pool.erase(price)){
+                prices.erase(price);
+            }
+        }
+};
+
+class LadderLevels{
+    private:
+        PoolArena arena;
+        PriceLadder<std::greater<unsigned>> ladder{&arena.pool(sizeof(OrderNode)), &arena, 100};
+    public:
+        bool empty() const{ return ladder.empty(); }
+        unsigned best() const{ return ladder.best(); }
+        void add(unsigned price){ ladder.try_emplace(price); }
+        void erase(unsigned price){ ladder.erase(price); }
+};
+
+struct Step{
+    bool add;
+    unsigned price;
+};
+
+std::vector<Step> makeSteps(size_t count){
+    std::mt19937 random(7);
+    std::normal_distribution<double> depth(0, 40);
+    std::vector<Step> steps(count);
+    long mid = 5000000; // $500.00 in ITCH price units
+    for (auto &step : steps) {
+        mid += static_cast<long>(random() % 3) - 1;
+        long ticks = mid + std::abs(static_cast<long>(depth(random)));
+        step.add = random() % 2 == 0;
+        step.price = static_cast<unsigned>(ticks - ticks % 100 - 100 * (random() % 2));
+    }
+    return steps;
+}
+
+template<typename Levels>
+double run(const std::vector<Step> &steps, unsigned long &checksum){
+    Levels levels;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < steps.size(); ++i) {
+        if (steps[i].add) {
+            levels.add(steps[i].price);
+        } else {
+            levels.erase(steps[i].price);
+        }
+        if (!levels.empty()) {
+            checksum += levels.best();
+            if (i % 16 == 0) {
+                levels.erase(levels.best());
+            }
+        }
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - begin;
+    return seconds.count();
+}
+
+}
+
+int main(int argc, char **argv){
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 20000000;
+    std::vector<Step> steps = makeSteps(count);
+    unsigned long setChecksum = 0, ladderChecksum = 0;
+    double setSeconds = run<SetMapLevels>(steps, setChecksum);
+    double ladderSeconds = run<LadderLevels>(steps, ladderChecksum);
+    std::cout << "set + unordered_map: " << setSeconds * 1e9 / count << " ns/step" << std::endl;
+    std::cout << "price ladder:        " << ladderSeconds * 1e9 / count << " ns/step ("
+              << setSeconds / ladderSeconds << "x)" << std::endl;
+    if (setChecksum != ladderChecksum) {
+        std::cout << "best prices differ!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../OrderMatcher/orderbook.hh"
+
+/*
+    Match loop throughput: every round rests 'orders' asks spread at random
+    over 'levels' price levels, so that the orders of a level are scattered
+    in memory the way a busy book scatters them, then sweeps them all with
+    a handful of marketable buys (timed).
+    Usage: match_bench [orders] [levels] [rounds]
+*/
+int main(int argc, char **argv){
+    unsigned orders = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    unsigned levels = argc > 2 ? std::stoul(argv[2]) : 100;
+    unsigned rounds = argc > 3 ? std::stoul(argv[3]) : 5;
+    std::mt19937 random(5);
+    // trades go to ./output/match_bench if that directory exists
+    OrderBook book("match_bench", BookMode::MATCHING);
+    OrderId id = 1;
+    std::chrono::nanoseconds matchTime{0};
+    unsigned long fills = 0;
+    for (unsigned round = 0; round < rounds; ++round) {
+        for (unsigned i = 0; i < orders; ++i) {
+            unsigned price = 10000 + 100 * (random() % levels);
+            Order ask(id++, 1, price, 100, OrderSide::SELL, OrderType::LIMIT);
+            book.add_order(ask);
+        }
+        auto begin = std::chrono::steady_clock::now();
+        for (unsigned sweep = 0; sweep < 10; ++sweep) {
+            Order buy(id++, 2, 10000 + 100 * levels, 10u * orders, OrderSide::BUY, OrderType::LIMIT);
+            book.add_order(buy);
+        }
+        matchTime += std::chrono::steady_clock::now() - begin;
+        fills += orders;
+    }
+    std::cout << "Order node: " << sizeof(OrderNode) << " bytes, " << 64.0 / sizeof(OrderNode)
+              << " orders per cache line" << std::endl;
+    std::cout << "Match loop: " << static_cast<double>(matchTime.count()) / fills << " ns/fill, "
+              << fills / (matchTime.count() / 1e9) / 1e6 << " M fills/s" << std::endl;
+    return 0;
+}
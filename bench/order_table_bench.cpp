@@ -0,0 +1,85 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../OrderMatcher/order_table.hh"
+
+/*
+    Order id lookups under an ITCH-like id stream: the OrderTable against
+    the FlatHashMap alone. Ids are handed out sequentially; 'live' orders
+    rest at any time, most of them die young, a few live all day. Every
+    step adds one order, looks up two live ones (an execute and a cancel)
+    and deletes one.
+    Usage: order_table_bench [steps] [live]
+*/
+namespace {
+
+struct Step{
+    OrderId add;
+    OrderId lookup[2];
+    OrderId erase;
+};
+
+std::vector<Step> makeSteps(size_t count, size_t liveCount){
+    std::mt19937_64 random(11);
+    std::vector<OrderId> live;
+    OrderId next = OrderId(1) << 33;
+    for (size_t i = 0; i < liveCount; ++i) {
+        live.push_back(next++);
+    }
+    std::vector<Step> steps(count);
+    for (auto &step : steps) {
+        step.add = next++;
+        live.push_back(step.add);
+        for (auto &id : step.lookup) {
+            id = live[live.size() - 1 - random() % std::min<size_t>(live.size(), 4096)];
+        }
+        // one order in 64 is picked from the whole book, the rest near the top
+        size_t index = random() % 64 == 0 ? random() % live.size()
+                                          : live.size() - 1 - random() % std::min<size_t>(live.size(), 4096);
+        step.erase = live[index];
+        live[index] = live.back();
+        live.pop_back();
+    }
+    return steps;
+}
+
+template<typename Table>
+double run(const std::vector<Step> &steps, size_t liveCount, unsigned long &checksum){
+    Table table;
+    for (OrderId id = OrderId(1) << 33; id < (OrderId(1) << 33) + liveCount; ++id) {
+        table.try_emplace(id, static_cast<unsigned>(id));
+    }
+    auto begin = std::chrono::steady_clock::now();
+    for (const auto &step : steps) {
+        table.try_emplace(step.add, static_cast<unsigned>(step.add));
+        for (OrderId id : step.lookup) {
+            if (const unsigned *value = table.find(id)) {
+                checksum += *value;
+            }
+        }
+        table.erase(step.erase);
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - begin;
+    return seconds.count();
+}
+
+}
+
+int main(int argc, char **argv){
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    size_t liveCount = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    std::vector<Step> steps = makeSteps(count, liveCount);
+    unsigned long hashChecksum = 0, tableChecksum = 0;
+    double hashSeconds = run<FlatHashMap<OrderId, unsigned>>(steps, liveCount, hashChecksum);
+    double tableSeconds = run<OrderTable<unsigned>>(steps, liveCount, tableChecksum);
+    std::cout << "flat hash map: " << hashSeconds * 1e9 / count << " ns/step" << std::endl;
+    std::cout << "order table:   " << tableSeconds * 1e9 / count << " ns/step ("
+              << hashSeconds / tableSeconds << "x)" << std::endl;
+    if (hashChecksum != tableChecksum) {
+        std::cout << "lookups differ!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
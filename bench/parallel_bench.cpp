@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "../Replay/parallel_book_builder.h"
+#include "itch_synth.h"
+
+/*
+    Scaling of the pipelined replay from 1 to N book shards, all symbols.
+    Usage: parallel_bench [itch_file] [max_shards] [spin|park]
+*/
+int main(int argc, char **argv){
+    std::string path = argc > 1 ? argv[1] : "./synthetic.ITCH50";
+    if(argc <= 1){
+        itch_synth::generate(path, 20000000, 512);
+    }
+    // leave two hardware threads to the reader and the decoders;
+    // hardware_concurrency() may be 0 when unknown
+    unsigned hw = std::thread::hardware_concurrency();
+    unsigned maxShards = argc > 2 ? std::stoul(argv[2]) : (hw > 3 ? hw - 2 : 1);
+    maxShards = std::max(1u, maxShards);
+    WaitPolicy wait = (argc > 3 && std::string(argv[3]) == "park") ? WaitPolicy::PARK : WaitPolicy::SPIN;
+
+    double base = 0;
+    for (unsigned shards = 1; shards <= maxShards; shards *= 2) {
+        ParallelBookBuilder::Options options;
+        options.shards = shards;
+        options.decoders = std::max(1u, shards / 4);
+        options.wait = wait;
+        ParallelBookBuilder builder(path, {}, options);
+        builder.start();
+        double rate = builder.getFramesRead() / builder.getSeconds() / 1e6;
+        base = base == 0 ? rate : base;
+        std::cout << "shards " << shards << ", decoders " << options.decoders << ": "
+                  << rate << " M msg/s (" << rate / base << "x)" << std::endl;
+        // stop before doubling could pass maxShards or overflow
+        if (shards > maxShards / 2) {
+            break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../Parser/reader.h"
+#include "../Parser/mmap_reader.h"
+#include "../Parser/reader_factory.h"
+#include "itch_synth.h"
+
+/*
+    Throughput of the std::ifstream Reader against MmapReader on the same
+    file, and optionally of a gzip/zstd compressed copy or a MoldUDP64 pcap
+    capture of it.
+    Usage: reader_bench [itch_file [compressed_or_pcap_file]]; without a file
+    a synthetic day is generated in the working directory.
+*/
+double replay(Reader &reader, unsigned long &decoded){
+    decoded = 0;
+    auto begin = std::chrono::steady_clock::now();
+    while(!reader.eof() && reader.isValid()){
+        Message msg = reader.createMessage();
+        if(!msg.isEmpty()){
+            decoded++;
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+template<typename R>
+double replay(const std::string &path, unsigned long &decoded){
+    R reader(path);
+    return replay(reader, decoded);
+}
+
+int main(int argc, char **argv){
+    std::string path = argc > 1 ? argv[1] : "./synthetic.ITCH50";
+    if(argc <= 1){
+        auto frames = itch_synth::generate(path, 20000000);
+        std::cout << "Generated " << frames << " frames into " << path << std::endl;
+    }
+    unsigned long decodedStream = 0, decodedMapped = 0;
+    // warm the page cache so both readers see the same conditions
+    replay<MmapReader>(path, decodedMapped);
+    double stream = replay<Reader>(path, decodedStream);
+    double mapped = replay<MmapReader>(path, decodedMapped);
+    std::cout << "ifstream Reader : " << stream << " s, " << decodedStream / stream / 1e6 << " M decoded msg/s" << std::endl;
+    std::cout << "MmapReader      : " << mapped << " s, " << decodedMapped / mapped / 1e6 << " M decoded msg/s" << std::endl;
+    std::cout << "speedup         : " << stream / mapped << "x" << std::endl;
+    if(argc > 2){
+        unsigned long decodedCompressed = 0;
+        auto reader = openReader(argv[2]);
+        double compressed = replay(*reader, decodedCompressed);
+        std::cout << "second input    : " << compressed << " s, " << decodedCompressed / compressed / 1e6 << " M decoded msg/s" << std::endl;
+        if(decodedCompressed != decodedMapped){
+            return 1;
+        }
+    }
+    return decodedStream == decodedMapped ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <iostream>
+
+#include "../OrderMatcher/orderbook.hh"
+
+/*
+    Stop order triggering on a book holding 'stops' resting stops, half of
+    them buy stops above the market and half sell stops below it.
+    - steady: every round rests a share inside the spread and trades it,
+      and rests and deletes a bid that does not trade; no stop comes near
+      firing (timed per add)
+    - cascade: 'stops' buy stop limits, each one level above the last,
+      over a ladder of one-share asks; the first trade fires the first stop,
+      whose fill fires the next one, and so on (timed per fired stop)
+    Usage: stop_bench [stops] [rounds]
+*/
+namespace {
+
+double steady(unsigned stops, unsigned rounds){
+    // trades go to ./output/stop_bench if that directory exists
+    OrderBook book("stop_bench", BookMode::MATCHING);
+    OrderId id = 1;
+    for (unsigned level = 0; level < 50; ++level) {
+        Order bid(id++, 1, 9800 - 100 * level, 1000000, OrderSide::BUY, OrderType::LIMIT);
+        Order ask(id++, 1, 10100 + 100 * level, 1000000, OrderSide::SELL, OrderType::LIMIT);
+        book.add_order(bid);
+        book.add_order(ask);
+    }
+    for (unsigned i = 0; i < stops / 2; ++i) {
+        Order buy(id++, 1, 0, 30000 + 100 * (i % 1000), 10, OrderSide::BUY, OrderType::STOP);
+        Order sell(id++, 1, 0, 100 + 100 * (i % 40), 10, OrderSide::SELL, OrderType::STOP);
+        book.add_order(buy);
+        book.add_order(sell);
+    }
+    auto begin = std::chrono::steady_clock::now();
+    for (unsigned round = 0; round < rounds; ++round) {
+        Order sell(id++, 2, 10000, 1, OrderSide::SELL, OrderType::LIMIT);
+        book.add_order(sell);
+        Order buy(id++, 2, 10000, 1, OrderSide::BUY, OrderType::LIMIT);
+        book.add_order(buy);
+        Order bid(id, 2, 9900, 1, OrderSide::BUY, OrderType::LIMIT);
+        book.add_order(bid);
+        book.delete_order(id++);
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - begin;
+    return seconds.count() * 1e9 / (3.0 * rounds);
+}
+
+double cascade(unsigned stops, unsigned &fired){
+    OrderBook book("stop_bench", BookMode::MATCHING);
+    OrderId id = 1;
+    for (unsigned i = 0; i < stops + 2; ++i) {
+        Order ask(id++, 1, 10000 + 100 * i, 1, OrderSide::SELL, OrderType::LIMIT);
+        book.add_order(ask);
+    }
+    OrderId first = id;
+    for (unsigned i = 0; i < stops; ++i) {
+        unsigned stop = 10100 + 100 * i;
+        Order buy(id++, 1, stop + 100, stop, 1, OrderSide::BUY, OrderType::STOP_LIMIT);
+        book.add_order(buy);
+    }
+    auto begin = std::chrono::steady_clock::now();
+    Order buy(id++, 2, 10100, 2, OrderSide::BUY, OrderType::LIMIT);
+    book.add_order(buy);
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - begin;
+    fired = 0;
+    for (OrderId stop = first; stop < first + stops; ++stop) {
+        fired += !book.has_order(stop);
+    }
+    return seconds.count() * 1e9 / std::max(fired, 1u);
+}
+
+}
+
+int main(int argc, char **argv){
+    unsigned stops = argc > 1 ? std::stoul(argv[1]) : 100000;
+    unsigned rounds = argc > 2 ? std::stoul(argv[2]) : 2000000;
+    std::cout << "steady, " << stops << " resting stops: " << steady(stops, rounds) << " ns/add" << std::endl;
+    unsigned fired;
+    double perStop = cascade(stops, fired);
+    std::cout << "cascade: fired " << fired << " of " << stops << " stops, " << perStop << " ns/stop" << std::endl;
+    return 0;
+}
@@ -2,10 +2,15 @@
 
 
 BookBuilder::BookBuilder(const std::string &inputMessagePath,
-                         const std::string &outputMessageCSV
+                         const std::string &outputMessageCSV,
+                         const std::vector<std::string> &symbolFilters,
+                         bool memoryMapped,
+                         BookMode mode
                          ):
-        message_reader(inputMessagePath),
-        messageWriter(outputMessageCSV)
+        updater(mode),
+        message_reader(openReader(inputMessagePath, memoryMapped)),
+        messageWriter(outputMessageCSV),
+        frameFilter(symbolFilters)
 {
     std::cout << "Begin building book and matching orders" << std::endl;
     totalTime = time(0);
@@ -15,71 +20,39 @@ BookBuilder::~BookBuilder()
 {
     std::cout << "Finish building book and matching orders in "
     << difftime(time(0),totalTime) << "seconds."  << std::endl;
-    std::cout << "Total Add Order is " << totalAdd << " and "
-    << "Total Delete Order is " << totalDelete << std::endl;
+    std::cout << "Total Add Order is " << updater.getTotalAdd() << " and "
+    << "Total Delete Order is " << updater.getTotalDelete() << std::endl;
+    std::cout << "Total Execute is " << updater.getTotalExecute() << ", Total Cancel is "
+    << updater.getTotalCancel() << " and Total Replace is " << updater.getTotalReplace() << std::endl;
+    std::cout << "Filtered out " << frameFilter.getDropped() << " of "
+    << frameFilter.getDropped() + frameFilter.getAccepted() << " messages." << std::endl;
+    updater.getBook().get_pool_stats().print(std::cout);
+    if (pacer) {
+        pacer->print(std::cout);
+    }
 }
 
 void BookBuilder::start(){
-    while(!message_reader.eof() and message_reader.isValid()){
+    while(!message_reader->eof() and message_reader->isValid()){
         next();
     }
 }
 
 void BookBuilder::next(){
-    message = message_reader.createMessage();
-    if(!message.isEmpty()){
-        bool validMessage = updateMessage();
-        if(validMessage){
-            updateBook();
-        }
+    uint16_t length;
+    const char *frame = message_reader->nextFrame(length);
+    if(frame != nullptr and pacer){
+        // every frame keeps its slot, watched or not
+        pacer->wait(itch::View::Timestamp::get(frame));
     }
-}
-
-
-
-bool BookBuilder::updateMessage() {
-//    char typeMsg = message.getType();
-//
-//    if (typeMsg == 'A' or typeMsg == 'P') {
-//        return true;
-//    }
-
-    return true;
-
-}
-
-void BookBuilder::updateBook() {
-    char typeMsg = message.getType();
-
-    if (typeMsg == 'A')
-    {
-        // if the ticket is in the selected array
-        if (in_array(message.getTicker(), SymbolFilters))
-        {
-            OrderType type = OrderType::LIMIT;
-            OrderSide side = (message.getSide() == 0) ? OrderSide::BUY: OrderSide::SELL;
-            Order thisOrder(message.getId(),0,
-                            static_cast<unsigned int>(message.getPrice()),message.getRemSize(),
-                            side ,type,0);
-            centralBook.add_order(message.getTicker(), thisOrder);
-//            centralBook.printBuySellPool(message.getTicker());
-//            message.print();
-            totalAdd += 1;
-        }
+    if(frame != nullptr and frameFilter.accept(frame, length)){
+        updateBook(frame, length);
     }
-    else if(typeMsg == 'D')
-    {
-        StatusCode s = centralBook.delete_order(message.getId());
-        if (s == StatusCode :: OK) {
-            totalDelete += 1;
-
-        }
+}
 
+void BookBuilder::updateBook(const char *frame, uint16_t length) {
+    BookEvent event;
+    if (decodeBookEvent(frame, length, event)) {
+        updater.apply(event);
     }
-    else
-    {
-        std::cerr << "Unexpected type! " << typeMsg << std::endl;
-    }
-
 }
-
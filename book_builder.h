@@ -2,29 +2,47 @@
 #define ORDER_MATCHING_ENGINE_BOOK_BUILDER_H
 
 #include "Parser/message.h"
+#include "Parser/book_event.h"
 #include "Parser/reader.h"
+#include "Parser/reader_factory.h"
+#include "Parser/frame_filter.h"
+#include "Parser/time_index.h"
 #include "Parser/writer.h"
-#include "OrderMatcher/order.hh"
-#include "OrderMatcher/central_order_book.hh"
+#include "book_updater.h"
+#include "Replay/replay_pacer.h"
 #include <algorithm>
+#include <memory>
 
 class BookBuilder{
 private:
-    Message message;
-    CentralOrderBook centralBook;
-    Reader message_reader;
+    BookUpdater updater;
+    std::unique_ptr<Reader> message_reader;
     Writer messageWriter;
     Writer bookWriter;
     Writer parserWriter;
     time_t totalTime;
-    std::vector<std::string> SymbolFilters =
-            { "AAPL", "MSFT", "TSLA", "AMZN"};
-    int totalAdd = 0;
-    int totalDelete = 0;
+    // drops frames of unwatched symbols before they are decoded
+    FrameFilter frameFilter;
+    // replays on exchange time when set
+    std::unique_ptr<ReplayPacer> pacer;
 
 public:
+    /**
+     * @param[in] inputMessagePath ITCH 5.0 file to replay, raw or
+     *            gzip/zstd compressed.
+     * @param[in] outputMessageCSV log file.
+     * @param[in] symbolFilters symbols to build books for; empty for all.
+     * @param[in] memoryMapped read raw input through MmapReader instead of
+     *            the std::ifstream based Reader.
+     * @param[in] mode PASSIVE mirrors the exchange book; MATCHING runs every
+     *            add through the matcher and stop orders.
+     */
     BookBuilder(const std::string &inputMessagePath,
-                const std::string &outputMessageCSV
+                const std::string &outputMessageCSV,
+                const std::vector<std::string> &symbolFilters =
+                        { "AAPL", "MSFT", "TSLA", "AMZN"},
+                bool memoryMapped = true,
+                BookMode mode = BookMode::PASSIVE
                 );
 
     ~BookBuilder();
@@ -33,14 +51,39 @@ public:
 
     void next();
 
-    bool updateMessage();
+    // false once the input turned out unreadable, corrupt or truncated
+    bool isValid() const{ return message_reader->isValid(); }
 
-    void updateBook();
+    /**
+     * Replays at 'speed' times exchange time from the next frame on,
+     * instead of flat out; see ReplayPacer. Lateness percentiles are
+     * printed at the end of the run.
+     */
+    void setPacing(double speed, WaitPolicy policy = WaitPolicy::SPIN){
+        pacer = std::make_unique<ReplayPacer>(speed, policy);
+    }
+    const ReplayPacer *getPacer() const{ return pacer.get(); }
 
-    bool in_array(const std::string &value, const std::vector<std::string> &array)
-    {
-        return std::find(array.begin(), array.end(), value) != array.end();
+    /**
+     * Skips ahead to the last 'index' entry at or before 'timestamp'; see
+     * Reader::seekToTime(). Books start empty from there.
+     */
+    bool seekToTime(uint64_t timestamp, const TimeIndex &index){
+        return message_reader->seekToTime(timestamp, index);
     }
+
+    /**
+     * Applies one raw ITCH frame to the central book. The frame is decoded
+     * through the ITCH dispatch table into a BookEvent on the stack, so
+     * nothing is allocated per message.
+     *
+     * @param[in] frame ITCH frame, starting at the message type.
+     * @param[in] length frame length from its prefix.
+     */
+    void updateBook(const char *frame, uint16_t length);
+
+    BookUpdater& getUpdater(){ return updater; }
+    CentralOrderBook& getBook(){ return updater.getBook(); }
 };
 
 
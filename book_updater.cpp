@@ -0,0 +1,57 @@
+#include "book_updater.h"
+
+#include <algorithm>
+
+void BookUpdater::apply(const BookEvent &event){
+    totalEvents++;
+    switch (event.type) {
+        case 'R':
+            // pre-build the locate table at session start
+            centralBook.add_locate(event.stockLocate, event.stock);
+            break;
+        case 'A':
+        case 'F':
+        {
+            if (centralBook.book_by_locate(event.stockLocate) == nullptr)
+            {
+                // no directory entry for this locate (e.g. partial file)
+                centralBook.add_locate(event.stockLocate, event.stock);
+            }
+            OrderType type = OrderType::LIMIT;
+            OrderSide side = (event.side == 'B') ? OrderSide::BUY: OrderSide::SELL;
+            Order thisOrder(event.orderRef,0,
+                            event.price,event.shares,
+                            side ,type,0);
+            centralBook.add_order_by_locate(event.stockLocate, thisOrder);
+            totalAdd += 1;
+            peakOrders = std::max<unsigned long>(peakOrders, centralBook.order_count());
+            break;
+        }
+        case 'E':
+        case 'C':
+            if (centralBook.execute_order(event.orderRef, event.shares) == StatusCode :: OK) {
+                totalExecute += 1;
+            }
+            break;
+        case 'X':
+            if (centralBook.reduce_order(event.orderRef, event.shares) == StatusCode :: OK) {
+                totalCancel += 1;
+            }
+            break;
+        case 'D':
+            if (centralBook.delete_order(event.orderRef) == StatusCode :: OK) {
+                totalDelete += 1;
+            }
+            break;
+        case 'U':
+            // side and type stay those of the original order
+            if (centralBook.replace_order(event.orderRef,
+                                          event.newOrderRef,
+                                          event.price, event.shares) == StatusCode :: OK) {
+                totalReplace += 1;
+            }
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef ORDER_MATCHING_ENGINE_BOOK_UPDATER_H
+#define ORDER_MATCHING_ENGINE_BOOK_UPDATER_H
+
+#include "Parser/book_event.h"
+#include "OrderMatcher/order.hh"
+#include "OrderMatcher/central_order_book.hh"
+
+/*
+    Applies decoded ITCH book events to a CentralOrderBook and keeps the
+    replay counters. Used by BookBuilder, and once per shard by the
+    parallel replay.
+
+    By default the book is PASSIVE: the feed already carries the exchange's
+    matching, so adds rest as they come and executions (E/C), partial
+    cancels (X), deletes (D) and replaces (U) are applied to the resting
+    orders directly.
+*/
+class BookUpdater{
+private:
+    CentralOrderBook centralBook;
+    unsigned long totalAdd = 0;
+    unsigned long totalDelete = 0;
+    unsigned long totalEvents = 0;
+    unsigned long totalExecute = 0;
+    unsigned long totalCancel = 0;
+    unsigned long totalReplace = 0;
+    unsigned long peakOrders = 0;
+
+public:
+    BookUpdater(BookMode mode = BookMode::PASSIVE) : centralBook(mode) {}
+
+    void apply(const BookEvent &);
+
+    CentralOrderBook& getBook(){ return centralBook; }
+    unsigned long getTotalAdd() const{ return totalAdd; }
+    unsigned long getTotalDelete() const{ return totalDelete; }
+    unsigned long getTotalEvents() const{ return totalEvents; }
+    // 'E' and 'C' executions applied
+    unsigned long getTotalExecute() const{ return totalExecute; }
+    // 'X' partial cancels applied
+    unsigned long getTotalCancel() const{ return totalCancel; }
+    // 'U' replaces applied
+    unsigned long getTotalReplace() const{ return totalReplace; }
+    // most orders resting at once
+    unsigned long getPeakOrders() const{ return peakOrders; }
+};
+
+#endif //ORDER_MATCHING_ENGINE_BOOK_UPDATER_H
@@ -1,9 +1,109 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <stdexcept>
 #include "book_builder.h"
+#include "Replay/parallel_book_builder.h"
+#include "Replay/cache_book_builder.h"
+#include "Replay/merged_book_builder.h"
+#include "Replay/batch_replay.h"
 
 using namespace std;
 
-int main() {
+/*
+    Usage: OME [itch_file ...] [-s SYM1,SYM2,...] [-f symbol_file] [--all]
+               [-t shards] [-d decoders] [--park] [--cache events_file]
+               [--from HH:MM:SS [--index index_file]] [--merge]
+               [--batch [-w workers] [--memory MB]] [--speed N] [--match]
+               [--reserve orders[,levels[,tickets]]]
+
+    -s  comma separated symbols to build books for
+    -f  file with one symbol per line
+    --all  build books for every symbol
+    -t  replay with the pipelined builder and this many book shard threads
+    -d  decode worker threads of the pipelined builder (default 1)
+    --park  let idle pipeline threads sleep instead of spinning
+    --cache  replay from this pre-decoded event cache, building it from
+             itch_file first if it is missing or stale
+    --from  start the sequential replay at this exchange time, through a
+            time index
+    --index  time index of itch_file (default itch_file.idx), built first
+             if it is missing or stale
+    --merge  replay all itch_files (one per venue) in one pass, merged by
+             timestamp, with a book per venue
+    --batch  replay every itch_file as an independent day on a worker pool
+             and print one merged report; itch_file may be a quoted wildcard
+             ('data/'*'.ITCH50') or @list_file with one path per line
+    -w  batch worker threads (default: one per hardware thread)
+    --memory  do not start more days while the process uses more than this
+              many MB
+    --speed  sequential replay paced at N times exchange time (1 = real
+             time), busy-waiting between messages (sleeping with --park);
+             prints lateness percentiles at the end
+    --match  sequential replay runs every add through the matcher and stop
+             orders instead of mirroring the exchange book (the default)
+    --reserve  sequential replay pre-allocates every book for this many
+               resting orders and price levels per side (default 256), and
+               the order index for 'tickets' orders (default: orders)
+*/
+
+/*
+    Print what went wrong and the synopsis above, and exit: a replay must not
+    start on a half understood command line.
+*/
+[[noreturn]] static void usage(const string &error) {
+    std::cerr << error << "\n"
+              << "Usage: OME [itch_file ...] [-s SYM1,SYM2,...] [-f symbol_file] [--all]\n"
+              << "           [-t shards] [-d decoders] [--park] [--cache events_file]\n"
+              << "           [--from HH:MM:SS [--index index_file]] [--merge]\n"
+              << "           [--batch [-w workers] [--memory MB]] [--speed N] [--match]\n"
+              << "           [--reserve orders[,levels[,tickets]]]" << std::endl;
+    exit(1);
+}
+
+/*
+    The value of 'option': a whole non-negative number, nothing before or
+    after it.
+*/
+static unsigned long parseCount(const string &option, const string &text) {
+    size_t used = 0;
+    unsigned long value = 0;
+    if (!text.empty() && isdigit(static_cast<unsigned char>(text[0]))) {
+        try {
+            value = stoul(text, &used);
+        } catch (const std::logic_error &) {
+            used = 0;
+        }
+    }
+    if (used == 0 || used != text.size()) {
+        usage("Invalid value " + text + " for " + option + ", expected a count");
+    }
+    return value;
+}
+
+/*
+    The value of 'option': a finite non-negative number, nothing before or
+    after it.
+*/
+static double parseRate(const string &option, const string &text) {
+    size_t used = 0;
+    double value = 0;
+    if (!text.empty() && (isdigit(static_cast<unsigned char>(text[0])) || text[0] == '.')) {
+        try {
+            value = stod(text, &used);
+        } catch (const std::logic_error &) {
+            used = 0;
+        }
+    }
+    if (used == 0 || used != text.size() || !std::isfinite(value)) {
+        usage("Invalid value " + text + " for " + option + ", expected a number");
+    }
+    return value;
+}
+
+int main(int argc, char **argv) {
     std::cout << "Welcome to the Nasdaq ITCH order matching engine" << std::endl;
 
 //    string file_path = "./data/03272019.PSX_ITCH50";
@@ -11,14 +111,156 @@ int main() {
 
     string outputMessageCSV = "./data/test.log";
 
+    vector<string> symbols = { "AAPL", "MSFT", "TSLA", "AMZN"};
+    bool customSymbols = false;
+    ParallelBookBuilder::Options options;
+    bool pipelined = false;
+    string cache_path;
+    string index_path;
+    uint64_t from_time = 0;
+    bool seek = false;
+    vector<string> files;
+    bool merge = false;
+    bool batch = false;
+    BatchReplay::Options batchOptions;
+    double speed = 0;
+    BookMode mode = BookMode::PASSIVE;
+    size_t reserve_orders = 0, reserve_levels = 256, reserve_tickets = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) {
+            symbols = customSymbols ? symbols : vector<string>();
+            for (const auto &symbol : FrameFilter::parseSymbols(argv[++i])) symbols.push_back(symbol);
+            customSymbols = true;
+        } else if (arg == "-f" && i + 1 < argc) {
+            symbols = customSymbols ? symbols : vector<string>();
+            for (const auto &symbol : FrameFilter::loadSymbols(argv[++i])) symbols.push_back(symbol);
+            customSymbols = true;
+        } else if (arg == "--all") {
+            symbols.clear();
+            customSymbols = true;
+        } else if (arg == "-t" && i + 1 < argc) {
+            options.shards = parseCount(arg, argv[++i]);
+            pipelined = true;
+        } else if (arg == "-d" && i + 1 < argc) {
+            options.decoders = parseCount(arg, argv[++i]);
+        } else if (arg == "--park") {
+            options.wait = WaitPolicy::PARK;
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cache_path = argv[++i];
+        } else if (arg == "--from" && i + 1 < argc) {
+            if (!parseTimeOfDay(argv[++i], from_time)) {
+                usage(string("Invalid time ") + argv[i] + " for --from, expected HH:MM:SS");
+            }
+            seek = true;
+        } else if (arg == "--index" && i + 1 < argc) {
+            index_path = argv[++i];
+        } else if (arg == "--merge") {
+            merge = true;
+        } else if (arg == "--speed" && i + 1 < argc) {
+            speed = parseRate(arg, argv[++i]);
+        } else if (arg == "--match") {
+            mode = BookMode::MATCHING;
+        } else if (arg == "--reserve" && i + 1 < argc) {
+            string list = argv[++i];
+            vector<size_t> counts;
+            size_t start = 0, end;
+            do {
+                end = std::min(list.find(',', start), list.size());
+                counts.push_back(parseCount(arg, list.substr(start, end - start)));
+                start = end + 1;
+            } while (end != list.size());
+            if (counts.size() > 3) {
+                usage("Invalid value " + list + " for --reserve, expected orders[,levels[,tickets]]");
+            }
+            reserve_orders = counts[0];
+            reserve_levels = counts.size() > 1 ? counts[1] : reserve_levels;
+            reserve_tickets = counts.size() > 2 ? counts[2] : reserve_orders;
+        } else if (arg == "--batch") {
+            batch = true;
+        } else if (arg == "-w" && i + 1 < argc) {
+            batchOptions.workers = parseCount(arg, argv[++i]);
+        } else if (arg == "--memory" && i + 1 < argc) {
+            batchOptions.memoryBudget = static_cast<size_t>(parseCount(arg, argv[++i])) << 20;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            usage("Unknown option or missing value: " + arg);
+        } else {
+            files.push_back(arg);
+        }
+    }
+    file_path = files.empty() ? file_path : files.back();
+
 
     std::cout << "---------------------start------------------------" << std::endl;
 
-    BookBuilder builder(file_path, outputMessageCSV);
-    builder.start();
+    if (batch) {
+        BatchReplay replay(BatchReplay::expandInputs(files), symbols, batchOptions);
+        replay.run().print(std::cout);
+    } else if (merge) {
+        MergedBookBuilder builder(files, symbols);
+        if (!builder.isValid()) {
+            return 1;
+        }
+        builder.start();
+        std::cout << "Merged " << builder.getFramesRead() << " messages of " << builder.venueCount()
+                  << " venues in " << builder.getSeconds() << " seconds." << std::endl;
+        for (unsigned v = 0; v < builder.venueCount(); ++v) {
+            std::cout << "Venue " << v << " (" << files[v] << "): Total Add Order is "
+                      << builder.getVenue(v).getTotalAdd() << " and Total Delete Order is "
+                      << builder.getVenue(v).getTotalDelete() << std::endl;
+        }
+    } else if (!cache_path.empty()) {
+        if (!EventCache(cache_path, file_path).isValid() && buildEventCache(file_path, cache_path) < 0) {
+            return 1;
+        }
+        // already checked against file_path above
+        CacheBookBuilder builder(cache_path, "", symbols);
+        builder.start();
+        BookUpdater &updater = builder.getUpdater();
+        std::cout << "Replayed " << updater.getTotalEvents() << " cached events in "
+                  << builder.getSeconds() << " seconds." << std::endl;
+        std::cout << "Total Add Order is " << updater.getTotalAdd() << " and "
+                  << "Total Delete Order is " << updater.getTotalDelete() << std::endl;
+    } else if (pipelined) {
+        ParallelBookBuilder builder(file_path, symbols, options);
+        builder.start();
+        unsigned long totalAdd = 0, totalDelete = 0;
+        for (unsigned s = 0; s < builder.shardCount(); ++s) {
+            totalAdd += builder.getShard(s).getTotalAdd();
+            totalDelete += builder.getShard(s).getTotalDelete();
+        }
+        std::cout << "Replayed " << builder.getFramesRead() << " messages on " << builder.shardCount()
+                  << " shards in " << builder.getSeconds() << " seconds." << std::endl;
+        std::cout << "Total Add Order is " << totalAdd << " and "
+                  << "Total Delete Order is " << totalDelete << std::endl;
+    } else {
+        BookBuilder builder(file_path, outputMessageCSV, symbols, true, mode);
+        if (reserve_orders > 0) {
+            builder.getBook().reserve(reserve_orders, reserve_levels, reserve_tickets);
+        }
+        if (seek) {
+            index_path = index_path.empty() ? file_path + ".idx" : index_path;
+            TimeIndex index(index_path, file_path);
+            if (!index.isValid()) {
+                index = TimeIndex::build(file_path, index_path);
+            }
+            if (!index.isValid() || !builder.seekToTime(from_time, index)) {
+                std::cerr << "Cannot seek " << file_path << std::endl;
+                return 1;
+            }
+        }
+        if (speed > 0) {
+            builder.setPacing(speed, options.wait);
+        }
+        builder.start();
+        if (!builder.isValid()) {
+            std::cerr << "Replay of " << file_path << " stopped on a corrupt or truncated input" << std::endl;
+            return 1;
+        }
+    }
 
     std::cout << "---------------------end------------------------" << std::endl;
 
 
     return 0;
-}
\ No newline at end of file
+}
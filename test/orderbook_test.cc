@@ -2,6 +2,8 @@
 
 // #include "gmock/gmock-matchers.h"
 #include <gtest/gtest.h>
+#include <unordered_map>
+#include <vector>
 
 // using testing::Matches;
 
@@ -223,9 +225,584 @@ TEST(OrderBook, DeleteStopOrder) {
   EXPECT_FALSE(order_obj);
 }
 
+TEST(OrderBook, StopOrdersCascade) {
+  CentralOrderBook book;
+  std::string s = "APPLE";
+  // one share at each of 1000..1040
+  for (unsigned i = 0; i < 5; ++i) {
+    Order ask(1 + i, 2, 1000 + 10 * i, 1, OrderSide::SELL, OrderType::LIMIT, 0);
+    EXPECT_EQ(StatusCode::OK, book.add_order(s, ask));
+  }
+  // each stop, once fired, buys the next level up
+  Order stop1(6,3,1020,1010,1,OrderSide::BUY,OrderType::STOP_LIMIT,0);
+  Order stop2(7,3,1030,1020,1,OrderSide::BUY,OrderType::STOP_LIMIT,0);
+  Order stop3(8,3,1050,1050,1,OrderSide::BUY,OrderType::STOP_LIMIT,0);
+  for (Order* order : {&stop1, &stop2, &stop3}) {
+    EXPECT_EQ(StatusCode::OK, book.add_order(s, *order));
+  }
+  // trades at 1000 and 1010 fire the first stop, whose fill at 1020 fires
+  // the second one
+  Order buy(9,4,1010,2,OrderSide::BUY,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy));
+  EXPECT_FALSE(book.get_order(6));
+  EXPECT_FALSE(book.get_order(7));
+  auto resting = book.get_order(8);
+  ASSERT_TRUE(resting);
+  EXPECT_EQ(OrderType::STOP_LIMIT, resting->get_type());
+  auto asks = book.side_depth(s, OrderSide::SELL).second;
+  EXPECT_EQ(1, asks.levels);
+  EXPECT_EQ(1040, book.best_ask(s).second);
+}
+
 TEST(OrderBook, DeleteOrderNotExists) {
   CentralOrderBook book;
   std::string s = "APPLE";
   EXPECT_EQ(StatusCode::ORDER_NOT_EXISTS, book.delete_order(1));
 }
 
+
+TEST(OrderBook, LocateIndexedBook) {
+  CentralOrderBook book;
+  EXPECT_EQ(nullptr, book.book_by_locate(13));
+  EXPECT_EQ(StatusCode::OK, book.add_locate(13, make_symbol_key("MSFT")));
+  EXPECT_NE(nullptr, book.book_by_locate(13));
+
+  Order buy1(1,2,1000,15,OrderSide::BUY,OrderType::LIMIT,0);
+  Order sell1(2,2,1100,15,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order_by_locate(13, buy1));
+  EXPECT_EQ(StatusCode::SYMBOL_NOT_EXISTS, book.add_order_by_locate(14, sell1));
+  // the locate and the symbol name lead to the same book
+  EXPECT_EQ(1000, book.best_bid("MSFT").second);
+  EXPECT_EQ(1000, book.book_by_locate(13)->best_bid());
+  EXPECT_EQ(StatusCode::OK, book.delete_order(1));
+  EXPECT_EQ(0, book.best_bid("MSFT").second);
+}
+
+TEST(OrderBook, PassiveBookDoesNotMatch) {
+  CentralOrderBook book(BookMode::PASSIVE);
+  std::string s = "APPLE";
+  Order buy1(1,2,1000,15,OrderSide::BUY,OrderType::LIMIT,0);
+  Order sell1(2,2,900,10,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy1));
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell1));
+  // crossed, but both rest untouched
+  EXPECT_EQ(1000, book.best_bid(s).second);
+  EXPECT_EQ(900, book.best_ask(s).second);
+  EXPECT_EQ(15, book.get_order(1)->get_quantity());
+  EXPECT_EQ(10, book.get_order(2)->get_quantity());
+  EXPECT_EQ(2, book.order_count());
+}
+
+TEST(OrderBook, ExecuteAndCancelShares) {
+  CentralOrderBook book(BookMode::PASSIVE);
+  std::string s = "APPLE";
+  Order buy1(1,2,1000,15,OrderSide::BUY,OrderType::LIMIT,0);
+  Order buy2(2,2,1000,5,OrderSide::BUY,OrderType::LIMIT,0);
+  Order buy3(3,2,990,5,OrderSide::BUY,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy1));
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy2));
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy3));
+
+  EXPECT_EQ(StatusCode::OK, book.execute_order(1, 5));
+  EXPECT_EQ(10, book.get_order(1)->get_quantity());
+  EXPECT_EQ(StatusCode::OK, book.reduce_order(1, 4));
+  EXPECT_EQ(6, book.get_order(1)->get_quantity());
+  // executing the rest removes the order, the level stays for order 2
+  EXPECT_EQ(StatusCode::OK, book.execute_order(1, 6));
+  EXPECT_FALSE(book.get_order(1));
+  EXPECT_EQ(1000, book.best_bid(s).second);
+  EXPECT_EQ(StatusCode::OK, book.reduce_order(2, 5));
+  EXPECT_EQ(990, book.best_bid(s).second);
+  EXPECT_EQ(1, book.order_count());
+  EXPECT_EQ(StatusCode::ORDER_NOT_EXISTS, book.execute_order(1, 1));
+  EXPECT_EQ(StatusCode::ORDER_NOT_EXISTS, book.reduce_order(7, 1));
+}
+
+TEST(OrderBook, ReduceKeepsPriority) {
+  CentralOrderBook book;
+  std::string s = "APPLE";
+  Order buy1(1,2,1000,10,OrderSide::BUY,OrderType::LIMIT,0);
+  Order buy2(2,2,1000,10,OrderSide::BUY,OrderType::LIMIT,0);
+  Order sell1(3,3,1000,5,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy1));
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy2));
+  EXPECT_EQ(StatusCode::OK, book.reduce_order(1, 5));
+  // order 1 is still first in the queue
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell1));
+  EXPECT_FALSE(book.get_order(1));
+  EXPECT_EQ(10, book.get_order(2)->get_quantity());
+}
+
+TEST(OrderBook, MatchingDropsTicketsOfFilledOrders) {
+  CentralOrderBook book;
+  std::string s = "APPLE";
+  Order buy1(1,2,1000,10,OrderSide::BUY,OrderType::LIMIT,0);
+  Order buy2(2,2,990,10,OrderSide::BUY,OrderType::LIMIT,0);
+  Order stop(3,2,0,995,5,OrderSide::SELL,OrderType::STOP,0);
+  for (Order* order : {&buy1, &buy2, &stop}) {
+    EXPECT_EQ(StatusCode::OK, book.add_order(s, *order));
+  }
+  EXPECT_EQ(3, book.order_count());
+  // fills order 1 and trades away itself
+  Order sell1(4,3,1000,10,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell1));
+  EXPECT_EQ(2, book.order_count());
+  // a trade at 990 fires the stop, which fills against order 2
+  Order sell2(5,3,990,4,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell2));
+  EXPECT_FALSE(book.get_order(3));
+  EXPECT_EQ(1, book.get_order(2)->get_quantity());
+  EXPECT_EQ(1, book.order_count());
+  // a replace that fills the order it crosses
+  Order sell3(6,3,1100,1,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell3));
+  EXPECT_EQ(StatusCode::OK, book.replace_order(2, 7, 1100, 1));
+  EXPECT_FALSE(book.get_order(6));
+  EXPECT_EQ(0, book.order_count());
+}
+
+TEST(OrderBook, ReplacePriorityRules) {
+  CentralOrderBook book;
+  std::string s = "APPLE";
+  Order buy1(1,2,1000,10,OrderSide::BUY,OrderType::LIMIT,0);
+  Order buy2(2,2,1000,10,OrderSide::BUY,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy1));
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy2));
+
+  EXPECT_EQ(StatusCode::ORDER_NOT_EXISTS, book.replace_order(7, 8, 1000, 5));
+  EXPECT_EQ(StatusCode::ORDER_EXISTS, book.replace_order(1, 2, 1000, 5));
+
+  // same id, same price, smaller size: order 1 keeps its place
+  EXPECT_EQ(StatusCode::OK, book.replace_order(1, 1, 1000, 6));
+  EXPECT_EQ(6, book.get_order(1)->get_quantity());
+  EXPECT_EQ(OrderSide::BUY, book.get_order(1)->get_side());
+  Order sell1(3,3,1000,6,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell1));
+  EXPECT_FALSE(book.get_order(1));
+  EXPECT_EQ(10, book.get_order(2)->get_quantity());
+
+  // a new id is a new order, even at a smaller size
+  Order buy5(5,2,1000,10,OrderSide::BUY,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy5));
+  EXPECT_EQ(StatusCode::OK, book.replace_order(2, 6, 1000, 8));
+  EXPECT_FALSE(book.get_order(2));
+  Order sell2(7,3,1000,10,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell2));
+  EXPECT_FALSE(book.get_order(5));
+  EXPECT_EQ(8, book.get_order(6)->get_quantity());
+
+  // a larger size goes to the back of the queue
+  Order buy8(8,2,1000,10,OrderSide::BUY,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy8));
+  EXPECT_EQ(StatusCode::OK, book.replace_order(6, 6, 1000, 12));
+  Order sell3(9,3,1000,10,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell3));
+  EXPECT_FALSE(book.get_order(8));
+  EXPECT_EQ(12, book.get_order(6)->get_quantity());
+
+  // a new price moves the order to its new level
+  EXPECT_EQ(StatusCode::OK, book.replace_order(6, 6, 990, 12));
+  EXPECT_EQ(990, book.best_bid(s).second);
+}
+
+TEST(OrderBook, LevelAndSideAggregates) {
+  CentralOrderBook book;
+  std::string s = "APPLE";
+  Order buy1(1,2,1000,10,OrderSide::BUY,OrderType::LIMIT,0);
+  Order buy2(2,2,1000,20,OrderSide::BUY,OrderType::LIMIT,0);
+  Order buy3(3,2,990,30,OrderSide::BUY,OrderType::LIMIT,0);
+  Order stop(4,2,0,900,40,OrderSide::SELL,OrderType::STOP,0);
+  for (Order* order : {&buy1, &buy2, &buy3, &stop}) {
+    EXPECT_EQ(StatusCode::OK, book.add_order(s, *order));
+  }
+  auto expect_depth = [](const std::pair<StatusCode, DepthSummary>& depth, uint64_t quantity, size_t orders, size_t levels) {
+    EXPECT_EQ(StatusCode::OK, depth.first);
+    EXPECT_EQ(quantity, depth.second.quantity);
+    EXPECT_EQ(orders, depth.second.orders);
+    EXPECT_EQ(levels, depth.second.levels);
+  };
+  expect_depth(book.level_depth(s, OrderSide::BUY, 1000), 30, 2, 1);
+  expect_depth(book.level_depth(s, OrderSide::BUY, 980), 0, 0, 0);
+  // stop orders are not part of the visible book
+  expect_depth(book.side_depth(s, OrderSide::SELL), 0, 0, 0);
+  expect_depth(book.side_depth(s, OrderSide::BUY), 60, 3, 2);
+
+  EXPECT_EQ(StatusCode::OK, book.reduce_order(2, 5));
+  EXPECT_EQ(StatusCode::OK, book.replace_order(1, 1, 1000, 4));
+  expect_depth(book.level_depth(s, OrderSide::BUY, 1000), 19, 2, 1);
+  // fills: all of order 1 and 6 of order 2
+  Order sell1(6,3,1000,10,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell1));
+  expect_depth(book.level_depth(s, OrderSide::BUY, 1000), 9, 1, 1);
+  expect_depth(book.side_depth(s, OrderSide::BUY), 39, 2, 2);
+  EXPECT_EQ(StatusCode::OK, book.delete_order(2));
+  expect_depth(book.side_depth(s, OrderSide::BUY), 30, 1, 1);
+  // a fill that empties the last level
+  Order sell2(7,3,990,30,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell2));
+  expect_depth(book.side_depth(s, OrderSide::BUY), 0, 0, 0);
+  EXPECT_EQ(StatusCode::SYMBOL_NOT_EXISTS, book.side_depth("NONE", OrderSide::BUY).first);
+}
+
+TEST(OrderBook, AllOrNoneNeedsEnoughDepth) {
+  CentralOrderBook book;
+  std::string s = "APPLE";
+  Order sell1(1,2,100,5,OrderSide::SELL,OrderType::LIMIT,0);
+  Order sell2(2,2,101,5,OrderSide::SELL,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell1));
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, sell2));
+  // 20 shares cannot be filled up to 101: nothing trades, the order rests
+  Order big(3,3,101,20,OrderSide::BUY,OrderType::LIMIT,1);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, big));
+  EXPECT_EQ(5, book.get_order(1)->get_quantity());
+  EXPECT_EQ(20, book.get_order(3)->get_quantity());
+  EXPECT_EQ(StatusCode::OK, book.delete_order(3));
+  // 10 shares can
+  Order fits(4,3,101,10,OrderSide::BUY,OrderType::LIMIT,1);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, fits));
+  EXPECT_FALSE(book.get_order(1));
+  EXPECT_FALSE(book.get_order(2));
+  EXPECT_FALSE(book.get_order(4));
+}
+
+TEST(OrderBook, DepthSnapshots) {
+  CentralOrderBook book;
+  std::string s = "APPLE";
+  std::vector<Order> orders = {
+    Order(1,2,1000,10,OrderSide::BUY,OrderType::LIMIT,0), Order(2,2,1000,20,OrderSide::BUY,OrderType::LIMIT,0),
+    Order(3,2,990,30,OrderSide::BUY,OrderType::LIMIT,0), Order(4,2,1010,5,OrderSide::SELL,OrderType::LIMIT,0),
+    Order(5,2,0,900,40,OrderSide::SELL,OrderType::STOP,0)};
+  for (Order& order : orders) {
+    EXPECT_EQ(StatusCode::OK, book.add_order(s, order));
+  }
+  EXPECT_EQ(StatusCode::OK, book.add_symbol("MSFT"));
+  DepthLevel levels[4];
+  auto depth = book.depth(s, OrderSide::BUY, levels, 4);
+  EXPECT_EQ(StatusCode::OK, depth.first);
+  ASSERT_EQ(2, depth.second);
+  EXPECT_EQ(1000, levels[0].price);
+  EXPECT_EQ(2, levels[0].orders);
+  EXPECT_EQ(30, levels[0].quantity);
+  EXPECT_EQ(990, levels[1].price);
+  EXPECT_EQ(1, book.depth(s, OrderSide::BUY, levels, 1).second);
+  EXPECT_EQ(SYMBOL_NOT_EXISTS, book.depth("NONE", OrderSide::BUY, levels, 4).first);
+
+  // a new best level, then the old best one is gone
+  Order buy(6,2,1005,7,OrderSide::BUY,OrderType::LIMIT,0);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, buy));
+  EXPECT_EQ(StatusCode::OK, book.delete_order(1));
+  EXPECT_EQ(StatusCode::OK, book.delete_order(2));
+  std::pair<SymbolKey, DepthSnapshot<3>> snapshots[2];
+  ASSERT_EQ(2, book.snapshot_all(snapshots, 2));
+  EXPECT_EQ(1, book.snapshot_all(snapshots, 1));
+  book.snapshot_all(snapshots, 2);
+  if (snapshots[0].first != make_symbol_key(s)) {
+    std::swap(snapshots[0], snapshots[1]);
+  }
+  EXPECT_EQ(make_symbol_key("MSFT"), snapshots[1].first);
+  EXPECT_EQ(0, snapshots[1].second.bid_levels + snapshots[1].second.ask_levels);
+  const DepthSnapshot<3>& apple = snapshots[0].second;
+  ASSERT_EQ(2, apple.bid_levels);
+  EXPECT_EQ(1005, apple.bids[0].price);
+  EXPECT_EQ(7, apple.bids[0].quantity);
+  EXPECT_EQ(990, apple.bids[1].price);
+  // stop orders are not part of the visible book
+  ASSERT_EQ(1, apple.ask_levels);
+  EXPECT_EQ(1010, apple.asks[0].price);
+  EXPECT_EQ(1, apple.asks[0].orders);
+}
+
+TEST(OrderBook, ColdAttributesSurviveChanges) {
+  CentralOrderBook book(BookMode::PASSIVE);
+  std::string s = "APPLE";
+  auto time = std::chrono::system_clock::time_point(std::chrono::seconds(1000));
+  Order stop(1, 42, 900, 950, 30, OrderSide::SELL, OrderType::STOP_LIMIT, 0, time);
+  Order limit(2, 43, 1000, 20, OrderSide::BUY, OrderType::LIMIT, 1, time);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, stop));
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, limit));
+  EXPECT_EQ(StatusCode::OK, book.reduce_order(2, 5));
+  auto resting = book.get_order(2);
+  ASSERT_TRUE(resting);
+  EXPECT_EQ(43, resting->get_owner());
+  EXPECT_EQ(1000, resting->get_quote());
+  EXPECT_EQ(15, resting->get_quantity());
+  EXPECT_EQ(1, resting->isAON());
+  EXPECT_EQ(time, resting->get_time());
+  resting = book.get_order(1);
+  ASSERT_TRUE(resting);
+  EXPECT_EQ(42, resting->get_owner());
+  EXPECT_EQ(900, resting->get_quote());
+  EXPECT_EQ(950, resting->get_stop_price());
+  EXPECT_EQ(OrderType::STOP_LIMIT, resting->get_type());
+  // a departed order's cold record is reused by the next one
+  EXPECT_EQ(StatusCode::OK, book.delete_order(1));
+  Order next(3, 44, 1100, 10, OrderSide::SELL, OrderType::LIMIT);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, next));
+  EXPECT_EQ(44, book.get_order(3)->get_owner());
+  EXPECT_EQ(43, book.get_order(2)->get_owner());
+  EXPECT_EQ(2, book.get_pool_stats().cold.peak);
+}
+
+TEST(OrderBook, ReservedPoolsDoNotGrow) {
+  CentralOrderBook book(BookMode::PASSIVE);
+  std::string s = "APPLE";
+  book.reserve(100, 8, 100);
+  // books added later are reserved too
+  EXPECT_EQ(StatusCode::OK, book.add_symbol(s));
+  BookPoolStats reserved = book.get_pool_stats();
+  EXPECT_EQ(0, reserved.orders.in_use);
+  EXPECT_EQ(0, reserved.index.in_use);
+  EXPECT_GE(reserved.orders.capacity, 100);
+  EXPECT_GE(reserved.index.capacity, 200);
+  for (int round = 0; round < 3; ++round) {
+    for (unsigned id = 1; id <= 100; ++id) {
+      Order order(id, 1, 1000 + 100 * (id % 8), 10, id % 2 ? OrderSide::BUY : OrderSide::SELL, OrderType::LIMIT, 0);
+      EXPECT_EQ(StatusCode::OK, book.add_order(s, order));
+    }
+    BookPoolStats full = book.get_pool_stats();
+    EXPECT_EQ(100, full.orders.in_use);
+    // every price is on the cent grid, so no level is in a fallback map
+    EXPECT_EQ(0, full.levels.in_use);
+    for (unsigned id = 1; id <= 100; ++id) {
+      EXPECT_EQ(StatusCode::OK, book.delete_order(id));
+    }
+  }
+  BookPoolStats after = book.get_pool_stats();
+  EXPECT_EQ(0, after.orders.in_use);
+  EXPECT_EQ(0, after.levels.in_use);
+  EXPECT_EQ(100, after.orders.peak);
+  // freed nodes were recycled, nothing new was allocated
+  EXPECT_EQ(reserved.orders.capacity, after.orders.capacity);
+  EXPECT_EQ(reserved.levels.capacity, after.levels.capacity);
+  EXPECT_EQ(reserved.index.capacity, after.index.capacity);
+  EXPECT_EQ(reserved.orders.slabs + reserved.levels.slabs + reserved.index.slabs,
+            after.orders.slabs + after.levels.slabs + after.index.slabs);
+}
+
+TEST(PriceLadder, BestAndNextInPriorityOrder) {
+  PoolArena arena;
+  PriceLadder<std::greater<unsigned>> bids(&arena.pool(sizeof(OrderNode)), &arena, 100);
+  PriceLadder<std::less<unsigned>> asks(&arena.pool(sizeof(OrderNode)), &arena, 100);
+  EXPECT_TRUE(bids.empty());
+  // 1050 is off the grid and 900000 too far away: both go to the fallback map
+  for (unsigned price : {10000u, 9900u, 1050u, 10200u, 900000u}) {
+    EXPECT_TRUE(bids.try_emplace(price).second);
+    EXPECT_TRUE(asks.try_emplace(price).second);
+  }
+  EXPECT_FALSE(bids.try_emplace(9900).second);
+  EXPECT_EQ(5, bids.size());
+  EXPECT_EQ(2, bids.outliers());
+
+  std::vector<unsigned> order;
+  unsigned price = bids.best();
+  do { order.push_back(price); } while (bids.next(price));
+  EXPECT_EQ((std::vector<unsigned>{900000, 10200, 10000, 9900, 1050}), order);
+  order.clear();
+  price = asks.best();
+  do { order.push_back(price); } while (asks.next(price));
+  EXPECT_EQ((std::vector<unsigned>{1050, 9900, 10000, 10200, 900000}), order);
+
+  bids.erase(900000);
+  bids.erase(10200);
+  EXPECT_EQ(10000, bids.best());
+  EXPECT_EQ(nullptr, bids.find(10200));
+  EXPECT_NE(nullptr, bids.find(1050));
+}
+
+TEST(PriceLadder, RecentersAsPricesDrift) {
+  PoolArena arena;
+  SlabPool* nodes = &arena.pool(sizeof(OrderNode));
+  PriceLadder<std::less<unsigned>> asks(nodes, &arena, 1);
+  OrderNode* node = asks.try_emplace(20000).first->push_back(1, 10, 0, false);
+  // walk the market down by 10000 ticks, a level at a time, leaving a
+  // deep level behind
+  for (unsigned price = 19999; price >= 10000; --price) {
+    asks.try_emplace(price);
+    if (price < 19990) {
+      asks.erase(price + 10);
+    }
+  }
+  EXPECT_EQ(10000, asks.best());
+  EXPECT_EQ(11, asks.size());
+  unsigned price = 10009;
+  EXPECT_TRUE(asks.next(price));
+  EXPECT_EQ(20000, price);
+  EXPECT_FALSE(asks.next(price));
+  // the deep level was pushed out of the window with its order intact
+  EXPECT_EQ(1, asks.outliers());
+  EXPECT_EQ(node, &*asks.find(20000)->begin());
+  asks.erase(20000);
+  EXPECT_EQ(0, asks.outliers());
+  EXPECT_EQ(10000, asks.best());
+}
+
+TEST(PriceLadder, DepthMatchesLadderWalk) {
+  PoolArena arena;
+  PriceLadder<std::greater<unsigned>> bids(&arena.pool(sizeof(OrderNode)), &arena, 100);
+  unsigned long seed = 3;
+  auto random = [&seed]() { return static_cast<unsigned>((seed = seed * 6364136223846793005ULL + 1) >> 33); };
+  std::vector<DepthLevel> levels(PriceLadder<std::greater<unsigned>>::TOP_LEVELS + 10);
+  OrderId id = 1;
+  for (int step = 0; step < 20000; ++step) {
+    // mostly near the best levels, some off the grid or far away
+    unsigned price = 100000 + 100 * (random() % 60) + (random() % 16 == 0 ? 50 : 0) + (random() % 64 == 0 ? 1000000 : 0);
+    if (random() % 3 != 0) {
+      bids.push_back(price, id++, 1 + random() % 100, 0, false);
+    } else if (!bids.empty() && random() % 2 == 0) {
+      bids.erase(bids.best());
+    } else {
+      bids.erase(price);
+    }
+    size_t n = random() % levels.size();
+    size_t count = bids.depth(levels.data(), n);
+    // the same levels walking the ladder
+    size_t expected = 0;
+    if (!bids.empty()) {
+      unsigned level = bids.best();
+      do {
+        if (expected < n) {
+          const OrderQueue* queue = bids.find(level);
+          ASSERT_EQ(level, levels[expected].price);
+          ASSERT_EQ(queue->size(), levels[expected].orders);
+          ASSERT_EQ(queue->quantity(), levels[expected].quantity);
+        }
+        ++expected;
+      } while (expected < n && bids.next(level));
+    }
+    ASSERT_EQ(std::min(n, bids.size()), count);
+  }
+}
+
+TEST(BookSide, PriceOrderingPerSide) {
+  using Bids = BookSide<OrderSide::BUY>;
+  using Asks = BookSide<OrderSide::SELL>;
+  EXPECT_TRUE(Bids::better(1010, 1000));
+  EXPECT_TRUE(Asks::better(1000, 1010));
+  // a sell quoting 1000 trades with bids at 1000 and up, a buy quoting
+  // 1000 with asks at 1000 and down
+  EXPECT_TRUE(Bids::reaches(1000, 1000));
+  EXPECT_FALSE(Bids::reaches(1000, 990));
+  EXPECT_TRUE(Asks::reaches(1000, 990));
+  EXPECT_FALSE(Asks::reaches(1000, 1010));
+  // buy stops fire once the sell market reaches them, sell stops once the
+  // buy market comes down to them
+  EXPECT_TRUE(Bids::crossed(1000, 1000));
+  EXPECT_FALSE(Bids::crossed(1000, 990));
+  EXPECT_TRUE(Asks::crossed(1000, 1000));
+  EXPECT_FALSE(Asks::crossed(1000, 1010));
+
+  PoolArena arena;
+  Asks asks(&arena.pool(sizeof(OrderNode)), &arena, 10);
+  EXPECT_EQ(Asks::NO_PRICE, asks.best());
+  EXPECT_EQ(Asks::NO_PRICE, asks.market_price());
+  asks.levels.try_emplace(1010);
+  asks.last_price = 1020;
+  EXPECT_EQ(1010, asks.market_price());
+  asks.stops.try_emplace(900);
+  asks.stops.try_emplace(950);
+  asks.update_trigger();
+  EXPECT_EQ(950, asks.stop_trigger);
+}
+
+TEST(FlatHashMap, MatchesUnorderedMapWhileGrowing) {
+  FlatHashMap<unsigned, unsigned> map;
+  std::unordered_map<unsigned, unsigned> expected;
+  unsigned long seed = 1;
+  auto random = [&seed]() { return static_cast<unsigned>((seed = seed * 6364136223846793005ULL + 1) >> 33); };
+  for (unsigned step = 0; step < 200000; ++step) {
+    unsigned key = random() % 50000;
+    switch (random() % 4) {
+    case 0:
+    case 1:
+      EXPECT_EQ(expected.try_emplace(key, step).second, map.try_emplace(key, step).second);
+      break;
+    case 2:
+      EXPECT_EQ(expected.erase(key) == 1, map.erase(key));
+      break;
+    default:
+      const unsigned* value = map.find(key);
+      auto entry = expected.find(key);
+      ASSERT_EQ(entry != expected.end(), value != nullptr);
+      if (value) {
+        EXPECT_EQ(entry->second, *value);
+      }
+    }
+    ASSERT_EQ(expected.size(), map.size());
+  }
+  for (const auto& entry : expected) {
+    ASSERT_NE(nullptr, map.find(entry.first));
+    EXPECT_EQ(entry.second, *map.find(entry.first));
+  }
+}
+
+TEST(FlatHashMap, ReserveAvoidsGrowing) {
+  FlatHashMap<unsigned, unsigned> map;
+  map.reserve(1000);
+  PoolStats reserved = map.get_stats();
+  EXPECT_GE(reserved.capacity, 1000);
+  for (unsigned id = 0; id < 1000; ++id) {
+    EXPECT_TRUE(map.try_emplace(id * 7919, id).second);
+  }
+  PoolStats full = map.get_stats();
+  EXPECT_EQ(1000, full.in_use);
+  EXPECT_EQ(reserved.capacity, full.capacity);
+  EXPECT_EQ(1, full.slabs);
+}
+
+TEST(OrderBook, SixtyFourBitOrderIds) {
+  CentralOrderBook book(BookMode::PASSIVE);
+  std::string s = "APPLE";
+  // equal in their low 32 bits
+  OrderId low = 7, high = (OrderId(1) << 32) + 7;
+  Order first(low, 1, 1000, 10, OrderSide::BUY, OrderType::LIMIT);
+  Order second(high, 1, 1100, 20, OrderSide::SELL, OrderType::LIMIT);
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, first));
+  EXPECT_EQ(StatusCode::OK, book.add_order(s, second));
+  EXPECT_EQ(2, book.order_count());
+  EXPECT_EQ(StatusCode::OK, book.delete_order(low));
+  ASSERT_TRUE(book.get_order(high));
+  EXPECT_EQ(high, book.get_order(high)->get_id());
+  EXPECT_EQ(20, book.get_order(high)->get_quantity());
+}
+
+TEST(OrderTable, MatchesUnorderedMapOverSlidingIds) {
+  OrderTable<unsigned> table;
+  std::unordered_map<OrderId, unsigned> expected;
+  std::vector<OrderId> live;
+  unsigned long seed = 1;
+  auto random = [&seed]() { return static_cast<unsigned>((seed = seed * 6364136223846793005ULL + 1) >> 33); };
+  OrderId next = OrderId(1) << 40;
+  for (unsigned step = 0; step < 300000; ++step) {
+    unsigned action = random() % 16;
+    if (action < 7 || live.empty()) {
+      // mostly the next id, sometimes one from far away
+      OrderId id = action == 0 ? random() : next++;
+      EXPECT_EQ(expected.try_emplace(id, step).second, table.try_emplace(id, step).second);
+      live.push_back(id);
+    } else if (action < 15) {
+      // orders die young, a few live all day
+      size_t index = live.size() - 1 - random() % std::min<size_t>(live.size(), 64);
+      if (action == 14) {
+        index = random() % live.size();
+      }
+      OrderId id = live[index];
+      live[index] = live.back();
+      live.pop_back();
+      EXPECT_EQ(expected.erase(id) == 1, table.erase(id));
+    } else {
+      OrderId id = live[random() % live.size()];
+      ASSERT_NE(nullptr, table.find(id));
+      EXPECT_EQ(expected[id], *table.find(id));
+    }
+    ASSERT_EQ(expected.size(), table.size());
+  }
+  for (const auto& entry : expected) {
+    ASSERT_NE(nullptr, table.find(entry.first));
+    EXPECT_EQ(entry.second, *table.find(entry.first));
+  }
+  EXPECT_FALSE(table.contains(next));
+  // far ids are the only outliers, the sequential ones are indexed directly
+  EXPECT_LT(table.outliers(), expected.size());
+  // chunks of dead ids were released
+  EXPECT_LT(table.get_stats().capacity, next - (OrderId(1) << 40));
+}
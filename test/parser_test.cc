@@ -0,0 +1,419 @@
+#include "../Parser/reader.h"
+#include "../Parser/mmap_reader.h"
+#include "../Parser/itch_view.h"
+#include "../Parser/frame_filter.h"
+#include "../Parser/compressed_reader.h"
+#include "../Parser/reader_factory.h"
+#include "../Parser/event_cache.h"
+#include "../Parser/time_index.h"
+#include "../Parser/pcap_reader.h"
+#include "../OrderMatcher/symbol.hh"
+#include "../bench/itch_synth.h"
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+namespace {
+
+// two adds, a cancel and a delete for AAPL
+std::string write_sample(const std::string &path){
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  itch_synth::FrameWriter w;
+  w.type('A').u16(7).u16(0).u48(34200000000000ULL).u64(42).u8('B').u32(300)
+   .alpha("AAPL", 8).u32(1500000).flush(out);
+  w.type('F').u16(7).u16(0).u48(34200000000001ULL).u64(43).u8('S').u32(100)
+   .alpha("AAPL", 8).u32(1510000).alpha("GSCO", 4).flush(out);
+  w.type('X').u16(7).u16(0).u48(34200000000002ULL).u64(42).u32(100).flush(out);
+  w.type('D').u16(7).u16(0).u48(34200000000003ULL).u64(43).flush(out);
+  return path;
+}
+
+template<typename R, typename... Args>
+void check_frames(const std::string &path, Args... args){
+  R reader(path, args...);
+  ASSERT_TRUE(reader.isValid());
+  uint16_t length = 0;
+
+  const char *frame = reader.nextFrame(length);
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(36, length);
+  itch::AddOrderView add(frame);
+  EXPECT_EQ('A', add.type());
+  EXPECT_EQ(7, add.stockLocate());
+  EXPECT_EQ(34200000000000ULL, add.timestamp());
+  EXPECT_EQ(42u, add.orderRef());
+  EXPECT_TRUE(add.isBuy());
+  EXPECT_EQ(300u, add.shares());
+  EXPECT_EQ("AAPL", add.stock().str());
+  EXPECT_EQ(make_symbol_key("AAPL"), add.stock().key());
+  EXPECT_EQ(1500000u, add.price());
+
+  frame = reader.nextFrame(length);
+  ASSERT_NE(nullptr, frame);
+  itch::AddOrderMpidView mpid(frame);
+  EXPECT_EQ(40, length);
+  EXPECT_FALSE(mpid.isBuy());
+  EXPECT_EQ("GSCO", mpid.attribution());
+
+  frame = reader.nextFrame(length);
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(100u, itch::OrderCancelView(frame).cancelledShares());
+
+  frame = reader.nextFrame(length);
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(43u, itch::OrderDeleteView(frame).orderRef());
+
+  EXPECT_EQ(nullptr, reader.nextFrame(length));
+  EXPECT_TRUE(reader.eof());
+}
+
+}
+
+TEST(Parser, StreamReaderFrames) {
+  check_frames<Reader>(write_sample("./parser_test_stream.itch"));
+}
+
+TEST(Parser, MmapReaderFrames) {
+  check_frames<MmapReader>(write_sample("./parser_test_mmap.itch"));
+}
+
+TEST(Parser, SymbolKeyRoundTrip) {
+  EXPECT_EQ("MSFT", symbol_name(make_symbol_key("MSFT")));
+  EXPECT_NE(make_symbol_key("MSFT"), make_symbol_key("MSF"));
+}
+
+namespace {
+
+struct AddCounter{
+  int adds = 0;
+  int deletes = 0;
+  void on(const itch::AddOrderView &){ adds++; }
+  void on(const itch::OrderDeleteView &){ deletes++; }
+};
+
+}
+
+TEST(Parser, SchemaLengths) {
+  EXPECT_EQ(36, itch::message_lengths['A']);
+  EXPECT_EQ(40, itch::message_lengths['F']);
+  EXPECT_EQ(19, itch::message_lengths['D']);
+  EXPECT_EQ(50, itch::message_lengths['I']);
+  EXPECT_EQ(0, itch::message_lengths['T']);
+  EXPECT_EQ(8u, itch::AddOrderView::OrderRef::width);
+}
+
+TEST(Parser, DispatchTable) {
+  itch_synth::FrameWriter w;
+  AddCounter counter;
+  w.type('F').u16(1).u16(0).u48(1).u64(5).u8('B').u32(1).alpha("MSFT", 8).u32(1).alpha("GSCO", 4);
+  EXPECT_TRUE(itch::dispatch(counter, w.bytes().data(), 40));
+  // handled type, but frame shorter than the schema says
+  EXPECT_FALSE(itch::dispatch(counter, w.bytes().data(), 20));
+  w.type('E').u16(1).u16(0).u48(1).u64(5).u32(1).u64(9);
+  EXPECT_FALSE(itch::dispatch(counter, w.bytes().data(), 31));
+  w.type('D').u16(1).u16(0).u48(1).u64(5);
+  EXPECT_TRUE(itch::dispatch(counter, w.bytes().data(), 19));
+  EXPECT_EQ(1, counter.adds);
+  EXPECT_EQ(1, counter.deletes);
+}
+
+TEST(Parser, CreateMessageSkipsUnknownTypes) {
+  std::string path = "./parser_test_unknown.itch";
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    itch_synth::FrameWriter w;
+    // not an ITCH 5.0 type: must be skipped using its length prefix
+    w.type('T').u32(12345).flush(out);
+    w.type('A').u16(1).u16(0).u48(99).u64(77).u8('S').u32(200)
+     .alpha("TSLA", 8).u32(2500000).flush(out);
+  }
+  MmapReader reader(path);
+  Message skipped = reader.createMessage();
+  EXPECT_TRUE(skipped.isEmpty());
+  Message add = reader.createMessage();
+  EXPECT_EQ('A', add.getType());
+  EXPECT_EQ(77u, add.getId());
+  EXPECT_EQ("TSLA", add.getTicker());
+  EXPECT_EQ(200, add.getRemSize());
+  EXPECT_TRUE(reader.eof());
+}
+
+TEST(Parser, FrameFilterByLocate) {
+  FrameFilter filter(FrameFilter::parseSymbols("AAPL,TSLA"));
+  itch_synth::FrameWriter w;
+  // directory binds locate 1 to AAPL and 2 to MSFT
+  w.type('R').u16(1).u16(0).u48(1).alpha("AAPL", 8).alpha("", 20);
+  EXPECT_TRUE(filter.accept(w.bytes().data(), w.bytes().size()));
+  w.type('R').u16(2).u16(0).u48(1).alpha("MSFT", 8).alpha("", 20);
+  EXPECT_FALSE(filter.accept(w.bytes().data(), w.bytes().size()));
+  EXPECT_TRUE(filter.watched(1));
+  EXPECT_FALSE(filter.watched(2));
+
+  w.type('A').u16(2).u16(0).u48(2).u64(1).u8('B').u32(1).alpha("MSFT", 8).u32(1);
+  EXPECT_FALSE(filter.accept(w.bytes().data(), w.bytes().size()));
+  w.type('D').u16(2).u16(0).u48(3).u64(1);
+  EXPECT_FALSE(filter.accept(w.bytes().data(), w.bytes().size()));
+  w.type('E').u16(1).u16(0).u48(3).u64(2).u32(1).u64(1);
+  EXPECT_TRUE(filter.accept(w.bytes().data(), w.bytes().size()));
+
+  // no directory entry for locate 3: resolved from the first add
+  w.type('A').u16(3).u16(0).u48(4).u64(3).u8('S').u32(1).alpha("TSLA", 8).u32(1);
+  EXPECT_TRUE(filter.accept(w.bytes().data(), w.bytes().size()));
+  EXPECT_TRUE(filter.watched(3));
+  // system events are market wide
+  w.type('S').u16(0).u16(0).u48(5).u8('C');
+  EXPECT_TRUE(filter.accept(w.bytes().data(), w.bytes().size()));
+  EXPECT_EQ(3u, filter.getDropped());
+
+  // frames cut before the end of their type are dropped unread, and do not
+  // bind their locate
+  w.type('R').u16(4).u16(0).u48(6).alpha("AAPL", 8).alpha("", 20);
+  EXPECT_FALSE(filter.accept(w.bytes().data(), w.bytes().size() - 1));
+  w.type('A').u16(4).u16(0).u48(6).u64(4).u8('B').u32(1).alpha("AAPL", 8).u32(1);
+  EXPECT_FALSE(filter.accept(w.bytes().data(), 20));
+  EXPECT_FALSE(filter.watched(4));
+  EXPECT_FALSE(FrameFilter({}).accept(w.bytes().data(), 2));
+  EXPECT_EQ(5u, filter.getDropped());
+}
+
+namespace {
+
+std::string read_file(const std::string &path){
+  std::ifstream in(path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+std::string gzip_copy(const std::string &path){
+  std::string bytes = read_file(path);
+  std::string gzPath = path + ".gz";
+  gzFile gz = gzopen(gzPath.c_str(), "wb");
+  gzwrite(gz, bytes.data(), static_cast<unsigned>(bytes.size()));
+  gzclose(gz);
+  return gzPath;
+}
+
+}
+
+TEST(Parser, CompressedReaderFrames) {
+  std::string gzPath = gzip_copy(write_sample("./parser_test_gzip.itch"));
+  EXPECT_EQ(Compression::GZIP, detectCompression(gzPath));
+  EXPECT_EQ(Compression::NONE, detectCompression("./parser_test_gzip.itch"));
+  // the factory picks the reader from the header, not the extension
+  EXPECT_NE(nullptr, dynamic_cast<CompressedReader *>(openReader(gzPath).get()));
+  check_frames<CompressedReader>(gzPath, Compression::GZIP);
+}
+
+TEST(Parser, CompressedReaderAcrossChunks) {
+  std::string path = "./parser_test_chunks.itch";
+  itch_synth::generate(path, 2000, 8);
+  std::string gzPath = gzip_copy(path);
+  MmapReader raw(path);
+  // tiny chunks: most frames straddle two of them
+  CompressedReader compressed(gzPath, Compression::GZIP, 7, 2);
+  uint16_t rawLength, length;
+  unsigned long frames = 0;
+  while (const char *expected = raw.nextFrame(rawLength)) {
+    const char *frame = compressed.nextFrame(length);
+    ASSERT_NE(nullptr, frame);
+    ASSERT_EQ(rawLength, length);
+    ASSERT_EQ(0, std::memcmp(expected, frame, length));
+    frames++;
+  }
+  EXPECT_EQ(nullptr, compressed.nextFrame(length));
+  EXPECT_TRUE(compressed.eof());
+  EXPECT_TRUE(compressed.isValid());
+  EXPECT_GT(frames, 2000u);
+}
+
+TEST(Parser, CompressedReaderTruncatedFile) {
+  std::string path = "./parser_test_truncated.itch";
+  itch_synth::generate(path, 2000, 8);
+  std::string gzPath = gzip_copy(path);
+  std::string bytes = read_file(gzPath);
+  std::ofstream(gzPath, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size() * 2 / 3);
+
+  CompressedReader compressed(gzPath, Compression::GZIP, 4096, 2);
+  ASSERT_TRUE(compressed.isValid());
+  uint16_t length;
+  unsigned long frames = 0;
+  while (compressed.nextFrame(length) != nullptr) {
+    frames++;
+  }
+  EXPECT_GT(frames, 0u);
+  EXPECT_TRUE(compressed.eof());
+  // the frames before the cut are read, then the cut is an error, not EOF
+  EXPECT_FALSE(compressed.isValid());
+}
+
+TEST(Parser, EventCacheRoundTrip) {
+  std::string path = write_sample("./parser_test_cache.itch");
+  std::string cachePath = "./parser_test_cache.evt";
+  ASSERT_EQ(4, buildEventCache(path, cachePath));
+
+  EventCache cache(cachePath, path);
+  ASSERT_TRUE(cache.isValid());
+  ASSERT_EQ(4u, cache.size());
+  const BookEvent *event = cache.begin();
+  EXPECT_EQ('A', event[0].type);
+  EXPECT_EQ(7, event[0].stockLocate);
+  EXPECT_EQ(42u, event[0].orderRef);
+  EXPECT_EQ('B', event[0].side);
+  EXPECT_EQ(300u, event[0].shares);
+  EXPECT_EQ(make_symbol_key("AAPL"), event[0].stock);
+  EXPECT_EQ(1500000u, event[0].price);
+  EXPECT_EQ('F', event[1].type);
+  EXPECT_EQ('X', event[2].type);
+  EXPECT_EQ(100u, event[2].shares);
+  EXPECT_EQ('D', event[3].type);
+  EXPECT_EQ(34200000000003ULL, event[3].timestamp);
+
+  // built from a different file
+  std::string other = "./parser_test_cache_other.itch";
+  itch_synth::generate(other, 100, 4);
+  EXPECT_FALSE(EventCache(cachePath, other).isValid());
+  EXPECT_TRUE(EventCache(cachePath).isValid());
+  EXPECT_FALSE(EventCache(other).isValid());
+}
+
+TEST(Parser, EventCacheRejectsTruncatedSource) {
+  std::string path = write_sample("./parser_test_cache_truncated.itch");
+  std::string cachePath = "./parser_test_cache_truncated.evt";
+  ASSERT_EQ(4, buildEventCache(path, cachePath));
+  // cut the last frame short: the stale cache must go, not be rebuilt
+  // from the frames before the cut
+  std::string bytes = read_file(path);
+  std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size() - 5);
+  EXPECT_EQ(-1, buildEventCache(path, cachePath));
+  EXPECT_FALSE(std::ifstream(cachePath).is_open());
+  EXPECT_FALSE(EventCache(cachePath, path).isValid());
+}
+
+TEST(Parser, TimeIndexSeek) {
+  std::string path = "./parser_test_index.itch";
+  itch_synth::generate(path, 5000, 8);
+  std::string gzPath = gzip_copy(path);
+
+  // reference: offset, count and timestamp of every frame
+  std::vector<TimeIndexEntry> frames;
+  {
+    MmapReader reader(path);
+    uint16_t length;
+    while (true) {
+      TimeIndexEntry at{0, reader.getOffset(), reader.getCount()};
+      const char *frame = reader.nextFrame(length);
+      if (frame == nullptr) break;
+      at.timestamp = itch::View::Timestamp::get(frame);
+      frames.push_back(at);
+    }
+  }
+
+  TimeIndex index = TimeIndex::build(path, "./parser_test_index.idx", 500, 1000000000ULL);
+  ASSERT_TRUE(index.isValid());
+  EXPECT_TRUE(TimeIndex("./parser_test_index.idx", path).isValid());
+  EXPECT_TRUE(TimeIndex::build(gzPath, "./parser_test_index_gz.idx", 500).isValid());
+  EXPECT_FALSE(TimeIndex("./parser_test_index.idx", write_sample("./parser_test_index_other.itch")).isValid());
+  // a cut source gets no index, and the old one is left alone
+  std::string cutPath = "./parser_test_index_cut.itch";
+  std::string bytes = read_file(path);
+  std::ofstream(cutPath, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size() - 5);
+  EXPECT_FALSE(TimeIndex::build(cutPath, "./parser_test_index.idx", 500).isValid());
+  EXPECT_TRUE(TimeIndex("./parser_test_index.idx", path).isValid());
+  const auto &entries = index.getEntries();
+  ASSERT_GT(entries.size(), 9u);
+  EXPECT_EQ(0u, entries[0].offset);
+
+  EXPECT_EQ(nullptr, index.find(frames[0].timestamp - 1));
+  uint64_t target = frames[frames.size() * 2 / 3].timestamp;
+  const TimeIndexEntry *entry = index.find(target);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_LE(entry->timestamp, target);
+  EXPECT_GT((entry + 1)->timestamp, target);
+
+  auto check_seek = [&](Reader &reader){
+    ASSERT_TRUE(reader.seekToTime(target, index));
+    EXPECT_EQ(entry->offset, reader.getOffset());
+    EXPECT_EQ(entry->messageCount, reader.getCount());
+    uint16_t length;
+    const char *frame = reader.nextFrame(length);
+    ASSERT_NE(nullptr, frame);
+    EXPECT_EQ(frames[entry->messageCount].timestamp, itch::View::Timestamp::get(frame));
+    unsigned long rest = 1;
+    while (reader.nextFrame(length) != nullptr) rest++;
+    EXPECT_EQ(frames.size() - entry->messageCount, rest);
+  };
+  Reader stream(path);
+  check_seek(stream);
+  MmapReader mapped(path);
+  check_seek(mapped);
+  CompressedReader compressed(gzPath, Compression::GZIP, 4096, 2);
+  check_seek(compressed);
+  // compressed input only seeks forward
+  EXPECT_FALSE(compressed.seek(0, 0));
+  EXPECT_TRUE(mapped.seek(0, 0));
+
+  uint64_t nanos;
+  ASSERT_TRUE(parseTimeOfDay("15:59:00.5", nanos));
+  EXPECT_EQ(57540500000000ULL, nanos);
+  ASSERT_TRUE(parseTimeOfDay("09:30", nanos));
+  EXPECT_EQ(34200000000000ULL, nanos);
+  EXPECT_FALSE(parseTimeOfDay("25:00", nanos));
+  EXPECT_FALSE(parseTimeOfDay("9:30x", nanos));
+}
+
+TEST(Parser, PcapReaderMoldUDP64) {
+  std::string path = "./parser_test_mold.itch";
+  itch_synth::generate(path, 2000, 8);
+  std::vector<std::string> frames;
+  {
+    MmapReader raw(path);
+    uint16_t length;
+    while (const char *frame = raw.nextFrame(length)) frames.emplace_back(frame, length);
+  }
+
+  // every 7th packet lost, every 5th sent twice
+  std::string pcapPath = "./parser_test_mold.pcap";
+  itch_synth::mold_pcap(path, pcapPath, 5, 7, 5);
+  EXPECT_TRUE(detectPcap(pcapPath));
+  EXPECT_FALSE(detectPcap(path));
+  EXPECT_NE(nullptr, dynamic_cast<PcapReader *>(openReader(pcapPath).get()));
+
+  PcapReader reader(pcapPath);
+  ASSERT_TRUE(reader.isValid());
+  size_t expected = 0;
+  unsigned long lost = 0, repeated = 0, gaps = 0;
+  uint16_t length;
+  for (size_t packet = 1; (packet - 1) * 5 < frames.size(); ++packet) {
+    size_t inPacket = std::min<size_t>(5, frames.size() - (packet - 1) * 5);
+    if (packet % 7 == 0) {
+      lost += inPacket;
+      gaps += (packet * 5 < frames.size()) ? 1 : 0;
+      expected += inPacket;
+      continue;
+    }
+    repeated += packet % 5 == 0 ? inPacket : 0;
+    for (size_t i = 0; i < inPacket; ++i, ++expected) {
+      const char *frame = reader.nextFrame(length);
+      ASSERT_NE(nullptr, frame);
+      ASSERT_EQ(frames[expected], std::string(frame, length)) << expected;
+    }
+  }
+  EXPECT_EQ(nullptr, reader.nextFrame(length));
+  EXPECT_TRUE(reader.eof());
+  const MoldStats &stats = reader.getStats();
+  EXPECT_EQ(frames.size() - lost, stats.messages);
+  EXPECT_EQ(gaps, stats.gaps);
+  EXPECT_EQ(lost, stats.missed);
+  EXPECT_EQ(5u, stats.largestGap);
+  EXPECT_EQ(31u, stats.firstGap);
+  EXPECT_EQ(repeated, stats.duplicates);
+  EXPECT_EQ(0u, stats.malformed);
+
+  // other port: nothing read
+  PcapReader filtered(pcapPath, 1234);
+  EXPECT_EQ(nullptr, filtered.nextFrame(length));
+  EXPECT_EQ(0u, filtered.getStats().messages);
+
+  // the sidecar index keeps matching its capture on later runs
+  ASSERT_TRUE(TimeIndex::build(pcapPath, "./parser_test_mold.idx", 100).isValid());
+  EXPECT_TRUE(TimeIndex("./parser_test_mold.idx", pcapPath).isValid());
+}
@@ -0,0 +1,195 @@
+#include "../Replay/spsc_ring.h"
+#include "../Replay/parallel_book_builder.h"
+#include "../Replay/cache_book_builder.h"
+#include "../Replay/merged_book_builder.h"
+#include "../Replay/batch_replay.h"
+#include "../Replay/replay_pacer.h"
+#include "../book_builder.h"
+#include "../bench/itch_synth.h"
+
+#include <gtest/gtest.h>
+
+TEST(Replay, SpscRingKeepsOrder) {
+  for (WaitPolicy policy : {WaitPolicy::SPIN, WaitPolicy::PARK}) {
+    SpscRing<unsigned> ring(8, policy);
+    const unsigned total = 100000;
+    std::thread producer([&]{
+      unsigned batch[5];
+      for (unsigned i = 0; i < total; i += 5) {
+        for (unsigned k = 0; k < 5; ++k) batch[k] = i + k;
+        ring.push(batch, 5);
+      }
+      ring.close();
+    });
+    unsigned expected = 0, out[3];
+    while (size_t n = ring.pop(out, 3)) {
+      for (size_t k = 0; k < n; ++k) {
+        ASSERT_EQ(expected++, out[k]);
+      }
+    }
+    producer.join();
+    EXPECT_EQ(total, expected);
+  }
+}
+
+TEST(Replay, ParallelMatchesSequential) {
+  std::string path = "./replay_test.itch";
+  itch_synth::generate(path, 50000, 16);
+
+  BookBuilder sequential(path, "./replay_test.log", {});
+  sequential.start();
+
+  ParallelBookBuilder::Options options;
+  options.shards = 3;
+  options.decoders = 2;
+  options.batch = 7;
+  options.ringCapacity = 32;
+  ParallelBookBuilder parallel(path, {}, options);
+  parallel.start();
+
+  auto symbols = itch_synth::symbols(16);
+  for (uint16_t i = 0; i < symbols.size(); ++i) {
+    // the synthetic directory gives symbol i locate i + 1
+    const std::string &symbol = symbols[i];
+    uint16_t locate = i + 1;
+    CentralOrderBook &shardBook = parallel.getShard(parallel.shardOf(locate)).getBook();
+    EXPECT_EQ(sequential.getBook().best_bid(symbol), shardBook.best_bid(symbol)) << symbol;
+    EXPECT_EQ(sequential.getBook().best_ask(symbol), shardBook.best_ask(symbol)) << symbol;
+  }
+}
+
+TEST(Replay, CacheMatchesSequential) {
+  std::string path = "./replay_cache_test.itch";
+  std::string cachePath = "./replay_cache_test.evt";
+  itch_synth::generate(path, 50000, 16);
+  ASSERT_GT(buildEventCache(path, cachePath), 0);
+
+  std::vector<std::string> watched = {"AAPL", "TSLA"};
+  BookBuilder sequential(path, "./replay_cache_test.log", watched);
+  sequential.start();
+  CacheBookBuilder cached(cachePath, path, watched);
+  ASSERT_TRUE(cached.isValid());
+  cached.start();
+
+  EXPECT_GT(cached.getFiltered(), 0u);
+  for (const std::string &symbol : itch_synth::symbols(16)) {
+    EXPECT_EQ(sequential.getBook().best_bid(symbol), cached.getBook().best_bid(symbol)) << symbol;
+    EXPECT_EQ(sequential.getBook().best_ask(symbol), cached.getBook().best_ask(symbol)) << symbol;
+  }
+}
+
+TEST(Replay, MergeByTimestamp) {
+  std::vector<std::string> paths = {"./replay_merge_a.itch", "./replay_merge_b.itch", "./replay_merge_c.itch"};
+  uint64_t total = 0;
+  for (size_t v = 0; v < paths.size(); ++v) {
+    total += itch_synth::generate(paths[v], 20000, 8, static_cast<uint32_t>(11 + v));
+  }
+
+  FeedMerger merger(paths);
+  ASSERT_TRUE(merger.isValid());
+  MergedFrame frame;
+  uint64_t last = 0, frames = 0;
+  std::vector<uint64_t> perVenue(paths.size());
+  while (merger.next(frame)) {
+    ASSERT_LE(last, frame.timestamp);
+    ASSERT_EQ(frame.timestamp, itch::View::Timestamp::get(frame.frame));
+    last = frame.timestamp;
+    perVenue[frame.venue]++;
+    frames++;
+  }
+  EXPECT_EQ(total, frames);
+  EXPECT_EQ(total, merger.getMerged());
+  for (uint64_t count : perVenue) EXPECT_GT(count, 0u);
+
+  MergedBookBuilder merged(paths, {});
+  merged.start();
+  ASSERT_EQ(3u, merged.venueCount());
+  for (const std::string &symbol : itch_synth::symbols(8)) {
+    unsigned bid = 0, ask = std::numeric_limits<unsigned>::max();
+    for (unsigned v = 0; v < paths.size(); ++v) {
+      BookBuilder single(paths[v], "./replay_merge_test.log", {});
+      single.start();
+      EXPECT_EQ(single.getBook().best_bid(symbol), merged.getVenue(v).getBook().best_bid(symbol)) << symbol;
+      EXPECT_EQ(single.getBook().best_ask(symbol), merged.getVenue(v).getBook().best_ask(symbol)) << symbol;
+      bid = std::max(bid, single.getBook().best_bid(symbol).second);
+      ask = std::min(ask, single.getBook().best_ask(symbol).second);
+    }
+    EXPECT_EQ(bid, merged.best_bid(symbol).second) << symbol;
+    EXPECT_EQ(ask, merged.best_ask(symbol).second) << symbol;
+  }
+  EXPECT_EQ(StatusCode::SYMBOL_NOT_EXISTS, merged.best_bid("NOPE").first);
+}
+
+TEST(Replay, BatchMatchesSingleDays) {
+  std::vector<std::string> paths = {"./replay_batch_1.day", "./replay_batch_2.day", "./replay_batch_3.day"};
+  for (size_t d = 0; d < paths.size(); ++d) {
+    itch_synth::generate(paths[d], 10000 * (d + 1), 8, static_cast<uint32_t>(21 + d));
+  }
+  {
+    std::ofstream list("./replay_batch.list");
+    list << "# days\n./replay_batch_3.day\n";
+  }
+  auto inputs = BatchReplay::expandInputs({"./replay_batch_[12].day", "@./replay_batch.list"});
+  ASSERT_EQ(paths, inputs);
+
+  BatchReplay::Options options;
+  options.workers = 2;
+  // a 1 byte budget lets only one day run at a time
+  for (size_t budget : {size_t(0), size_t(1)}) {
+    options.memoryBudget = budget;
+    BatchReport report = BatchReplay(inputs, {}, options).run();
+    ASSERT_EQ(paths.size(), report.days.size());
+    for (size_t d = 0; d < paths.size(); ++d) {
+      BookBuilder single(paths[d], "./replay_batch_test.log", {});
+      single.start();
+      const DayReport &day = report.days[d];
+      EXPECT_TRUE(day.ok);
+      EXPECT_EQ(paths[d], day.path);
+      EXPECT_GT(day.messages, 10000 * (d + 1));
+      EXPECT_GT(day.fills, 0u);
+      EXPECT_GT(day.peakOrders, 0u);
+      EXPECT_EQ(single.getUpdater().getTotalAdd(), day.adds);
+      EXPECT_EQ(single.getUpdater().getTotalDelete(), day.deletes);
+    }
+    EXPECT_GT(report.peakResidentBytes, 0u);
+  }
+  EXPECT_FALSE(BatchReplay({"./replay_batch_missing.day"}, {}, options).run().days[0].ok);
+}
+
+TEST(Replay, LatencyHistogramPercentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.percentile(0.5));
+  for (uint64_t v = 1; v <= 1000; ++v) histogram.record(v * 1000);
+  EXPECT_EQ(1000u, histogram.count());
+  EXPECT_EQ(1000000u, histogram.max());
+  // within one sub-bucket (1/16) of the exact value
+  for (double p : {0.5, 0.9, 0.99}) {
+    double exact = p * 1000000;
+    EXPECT_NEAR(exact, static_cast<double>(histogram.percentile(p)), exact / 16) << p;
+  }
+  EXPECT_EQ(1000000u, histogram.percentile(1.0));
+  EXPECT_LE(histogram.percentile(0.5), histogram.percentile(0.9));
+}
+
+TEST(Replay, PacerFollowsExchangeTime) {
+  for (WaitPolicy policy : {WaitPolicy::SPIN, WaitPolicy::PARK}) {
+    // 40 ms of exchange time replayed at 2x
+    ReplayPacer pacer(2.0, policy);
+    PaceClock clock(false);
+    uint64_t begin = clock.now();
+    const uint64_t open = 34200000000000ULL;
+    for (uint64_t ms = 0; ms <= 40; ++ms) {
+      pacer.wait(open + ms * 1000000);
+    }
+    uint64_t elapsed = clock.now() - begin;
+    EXPECT_GE(elapsed, 19000000u);
+    EXPECT_EQ(41u, pacer.getPaced());
+
+    // a 10 ms stall shows up as lateness of the next frame
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint64_t late = pacer.wait(open + 40 * 1000000);
+    EXPECT_GE(late, 9000000u);
+    EXPECT_GE(pacer.getLateness().max(), late);
+    EXPECT_EQ(42u, pacer.getLateness().count());
+  }
+}